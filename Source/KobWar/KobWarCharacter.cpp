@@ -10,16 +10,26 @@
 #include "GameFramework/SpringArmComponent.h"
 #include "ActionControlComponent.h"
 #include "ClimbingComponent.h"
+#include "MovementValidationSubsystem.h"
+#include "StealthPerceptionSubsystem.h"
+#include "GamePlayerController.h"
+#include "MovementSnapshotComponent.h"
+#include "KobWarMovementComponent.h"
+#include "KobWarGameMode.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include <Runtime/Engine/Public/Net/UnrealNetwork.h>
 
 
 //////////////////////////////////////////////////////////////////////////
 // AKobWarCharacter
 
-AKobWarCharacter::AKobWarCharacter(const FObjectInitializer& ObjectInitializer) : AClientAuthoritativeCharacter(ObjectInitializer)
+AKobWarCharacter::AKobWarCharacter(const FObjectInitializer& ObjectInitializer) : AClientAuthoritativeCharacter(ObjectInitializer.SetDefaultSubobjectClass<UKobWarMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	bReplicates = true;
 
+	// climbing is a custom mode of this class - the client-authoritative base must not swap in its own movement component
+	ensureMsgf(Cast<UKobWarMovementComponent>(GetCharacterMovement()), TEXT("%s: character movement is %s, climbing needs UKobWarMovementComponent"), *GetName(), *GetNameSafe(GetCharacterMovement() ? GetCharacterMovement()->GetClass() : nullptr));
+
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
 
@@ -39,6 +49,10 @@ AKobWarCharacter::AKobWarCharacter(const FObjectInitializer& ObjectInitializer)
 	GetCharacterMovement()->AirControl = 0.2f;
 	UpdateSpeed();
 
+#if !UE_SERVER
+	// Cosmetic components are compiled out of dedicated server builds - nothing on the server views or hears the character.
+	// Blueprints must null-check GetCameraBoom and GetFollowCamera on the server.
+
 	// Create a camera boom (pulls in towards the player if there is a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
 	CameraBoom->SetupAttachment(RootComponent);
@@ -49,13 +63,17 @@ AKobWarCharacter::AKobWarCharacter(const FObjectInitializer& ObjectInitializer)
 	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
 	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+#endif
 
 	ActionControl = CreateDefaultSubobject<UActionControlComponent>(TEXT("ActionControl"));
 
 	LockOnTargetComponent = CreateDefaultSubobject<ULockOnTargSceneComponent>(TEXT("LockOnTargetComponent"));
 	LockOnTargetComponent->SetupAttachment(RootComponent);
 
+	// on dedicated servers too - it sends the character's sound events
 	SoundComponent = CreateDefaultSubobject<USoundPlayerComponent>(TEXT("SoundPlayer"));
+
+	MovementSnapshot = CreateDefaultSubobject<UMovementSnapshotComponent>(TEXT("MovementSnapshot"));
 }
 
 void AKobWarCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -70,6 +88,50 @@ void AKobWarCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& Out
 	sharedParams_NoCond.Condition = COND_None;
 
 	DOREPLIFETIME_WITH_PARAMS(AKobWarCharacter, GenericTeamId, sharedParams_NoCond);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AKobWarCharacter, IsPooled, sharedParams_NoCond);
+}
+
+void AKobWarCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority())
+	{
+		if (auto* movementValidation = GetWorld()->GetSubsystem<UMovementValidationSubsystem>())
+		{
+			movementValidation->RegisterCharacter(this);
+		}
+
+		if (auto* stealthPerception = GetWorld()->GetSubsystem<UStealthPerceptionSubsystem>())
+		{
+			stealthPerception->RegisterCharacter(this);
+		}
+	}
+}
+
+void AKobWarCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (auto* movementValidation = GetWorld()->GetSubsystem<UMovementValidationSubsystem>())
+	{
+		movementValidation->UnregisterCharacter(this);
+	}
+
+	if (auto* stealthPerception = GetWorld()->GetSubsystem<UStealthPerceptionSubsystem>())
+	{
+		stealthPerception->UnregisterCharacter(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AKobWarCharacter::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (UseBatchedInputCommands && IsLocallyControlled() && !HasAuthority())
+	{
+		SendInputCommand();
+	}
 }
 
 void AKobWarCharacter::PossessedBy(AController* NewController)
@@ -121,23 +183,91 @@ void AKobWarCharacter::ServerSetTeamId_Implementation(const uint8 NewTeamId)
 // Input
 
 void AKobWarCharacter::UpdateSpeed()
+{
+	GetCharacterMovement()->MaxWalkSpeed = GetTargetMoveSpeed();
+}
+
+float AKobWarCharacter::GetTargetMoveSpeed() const
 {
 	if (ActionControl && IsAiming)
 	{
-		GetCharacterMovement()->MaxWalkSpeed = ActionControl->GetAimMoveSpeed();
+		return ActionControl->GetAimMoveSpeed();
 	}
 	else if (IsStealthed)
 	{
-		GetCharacterMovement()->MaxWalkSpeed = BaseRunSpeed*0.6f;
+		return BaseRunSpeed*0.6f;
 	}
 	else if (IsRunning)
 	{
-		GetCharacterMovement()->MaxWalkSpeed = BaseRunSpeed;
+		return BaseRunSpeed;
 	}
-	else
+	return BaseMovementSpeed;
+}
+
+void AKobWarCharacter::ClientCorrectPosition_Implementation(FVector_NetQuantize Location)
+{
+	SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+	GetCharacterMovement()->StopMovementImmediately();
+}
+
+float AKobWarCharacter::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	float priority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	// Viewer is the connection's player controller
+	AGamePlayerController* viewerController = Cast<AGamePlayerController>(Viewer);
+	if (viewerController && viewerController->GetLockOnTargetActor() == this)
+	{
+		return priority * LockedOnNetPriorityScale;
+	}
+
+	if (bLowBandwidth && FVector::DistSquared(ViewPos, GetActorLocation()) > FMath::Square(DistantNetPriorityRange))
+	{
+		priority *= DistantNetPriorityScale;
+	}
+
+	return priority;
+}
+
+bool AKobWarCharacter::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	// hidden without collision would make the engine drop it, and clients would never see it leave the pool
+	if (IsPooled)
+		return true;
+
+	if (!Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation))
+		return false;
+
+	if (!IsStealthed || ViewTarget == this || RealViewer == GetController())
+		return true;
+
+	// an assassin nobody on that connection has noticed isn't sent to it at all
+	auto* stealthPerception = GetWorld()->GetSubsystem<UStealthPerceptionSubsystem>();
+	return !stealthPerception || stealthPerception->GetDetection(ViewTarget, this) >= StealthRelevantDetection;
+}
+
+void AKobWarCharacter::OnRep_ReplicatedMovement()
+{
+	if (MovementSnapshot && MovementSnapshot->IsDrivingSimulatedProxy())
+		return;
+
+	Super::OnRep_ReplicatedMovement();
+}
+
+void AKobWarCharacter::AddLockOnWatcher(bool Add)
+{
+	if (Add)
+	{
+		LockOnWatcherCount++;
+	}
+	else if (LockOnWatcherCount > 0)
 	{
-		GetCharacterMovement()->MaxWalkSpeed = BaseMovementSpeed;
+		LockOnWatcherCount--;
 	}
+
+	const float defaultFrequency = GetClass()->GetDefaultObject<AKobWarCharacter>()->NetUpdateFrequency;
+	NetUpdateFrequency = LockOnWatcherCount > 0 ? FMath::Max(defaultFrequency, LockedOnNetUpdateFrequency) : defaultFrequency;
+	ForceNetUpdate();
 }
 
 void AKobWarCharacter::UpdateCameraControlMode(bool ToggleLockedOn)
@@ -169,6 +299,182 @@ bool AKobWarCharacter::ActivateUniqueAction(FActionDataStruct& ActionData)
 	return ActionControl->TriggerOtherAction(ActionData);
 }
 
+void AKobWarCharacter::DeactivateForPool()
+{
+	if (!HasAuthority())
+		return;
+
+	if (Controller)
+	{
+		Controller->UnPossess();
+	}
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+
+	// players locked on to this character let go, or its raised update rate carries into its next life
+	for (FConstPlayerControllerIterator it = GetWorld()->GetPlayerControllerIterator(); it; ++it)
+	{
+		auto* gamePlayerController = Cast<AGamePlayerController>(it->Get());
+		if (gamePlayerController && gamePlayerController->GetLockOnTargetActor() == this)
+		{
+			gamePlayerController->ReleaseLockOnTarget();
+		}
+	}
+
+	IsPooled = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AKobWarCharacter, IsPooled, this);
+	ApplyPooledState();
+	ForceNetUpdate();
+}
+
+void AKobWarCharacter::ActivateFromPool(const FTransform& SpawnTransform, const uint8 TeamId)
+{
+	if (!HasAuthority())
+		return;
+
+	SetActorLocationAndRotation(SpawnTransform.GetLocation(), SpawnTransform.GetRotation(), false, nullptr, ETeleportType::ResetPhysics);
+	SetLocalTeamId(TeamId);
+
+	GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Walking);
+
+	if (auto* movementValidation = GetWorld()->GetSubsystem<UMovementValidationSubsystem>())
+	{
+		movementValidation->ResetCharacter(this);
+	}
+
+	IsPooled = false;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AKobWarCharacter, IsPooled, this);
+	ApplyPooledState();
+	ForceNetUpdate();
+}
+
+bool AKobWarCharacter::IsInPawnPool() const
+{
+	return IsPooled;
+}
+
+void AKobWarCharacter::OnRep_IsPooled()
+{
+	ApplyPooledState();
+}
+
+void AKobWarCharacter::ApplyPooledState()
+{
+	// collision and ticking don't replicate, so every machine applies them here or clients keep a colliding ghost
+	SetActorHiddenInGame(IsPooled);
+	SetActorEnableCollision(!IsPooled);
+	SetActorTickEnabled(!IsPooled);
+	SetComponentTicksPooled(IsPooled);
+
+	if (IsPooled)
+	{
+		ReleaseLocalLockOns();
+		ResetComponentsForPool();
+		OnResetForPool();
+	}
+	else if (MovementSnapshot)
+	{
+		// don't interpolate from where the character was before it entered the pool
+		MovementSnapshot->ClearSnapshotBuffer();
+	}
+}
+
+void AKobWarCharacter::SetComponentTicksPooled(bool Pooled)
+{
+	if (Pooled)
+	{
+		PooledTickingComponents.Reset();
+		for (UActorComponent* component : GetComponents())
+		{
+			if (component && component->IsComponentTickEnabled())
+			{
+				PooledTickingComponents.Add(component);
+				component->SetComponentTickEnabled(false);
+			}
+		}
+		return;
+	}
+
+	// only what was ticking before - components like the movement snapshot decide their own tick state
+	for (UActorComponent* component : PooledTickingComponents)
+	{
+		if (component)
+		{
+			component->SetComponentTickEnabled(true);
+		}
+	}
+	PooledTickingComponents.Reset();
+}
+
+void AKobWarCharacter::ReleaseLocalLockOns()
+{
+	for (FConstPlayerControllerIterator it = GetWorld()->GetPlayerControllerIterator(); it; ++it)
+	{
+		APlayerController* playerController = it->Get();
+		if (!playerController || !playerController->IsLocalController() || !playerController->GetPawn())
+			continue;
+
+		auto* lockOnComp = playerController->GetPawn()->FindComponentByClass<ULockOnComponent>();
+		ULockOnTargSceneComponent* lockOnTarget;
+		if (lockOnComp && lockOnComp->GetCurrentLockOnTarget(lockOnTarget) && lockOnTarget->GetOwner() == this)
+		{
+			lockOnComp->SetLockOnTarget(nullptr);
+		}
+	}
+}
+
+void AKobWarCharacter::ResetComponentsForPool()
+{
+	if (auto* climbingComp = FindComponentByClass<UClimbingComponent>())
+	{
+		climbingComp->ResetForPool();
+	}
+
+	if (auto* lockOnComp = FindComponentByClass<ULockOnComponent>())
+	{
+		lockOnComp->ResetForPool();
+	}
+
+	if (auto* stealthComp = FindComponentByClass<UStealthComponent>())
+	{
+		stealthComp->ResetForPool();
+	}
+
+	if (ActionControl)
+	{
+		ActionControl->ResetForPool();
+	}
+
+	if (SoundComponent)
+	{
+		SoundComponent->ResetForPool();
+	}
+
+	IsRunning = false;
+	IsAiming = false;
+	IsStealthed = false;
+	IsLockedOn = false;
+	AreInputsPausedForMenu = false;
+	PrevForwardInput = 0.0f;
+	PrevRightInput = 0.0f;
+	LocalButtonState = 0;
+	ServerButtonState = 0;
+	HasReceivedInputCommand = false;
+	ServerMoveInput = FVector2D::ZeroVector;
+	ServerViewInput = FVector2D::ZeroVector;
+	InputCommandHistory.Reset();
+	UpdateSpeed();
+
+	// pooled pawns are spawned as spectators, and ActivateFromPool assigns the next team
+	SetLocalTeamId(ETeam::Spectating);
+
+	if (CharacterState != ECharacterState::Ready)
+	{
+		UpdateState(ECharacterState::Ready);
+	}
+}
+
 void AKobWarCharacter::UpdateState(TEnumAsByte<ECharacterState> NewState)
 {
 	auto prevState = CharacterState;
@@ -277,6 +583,8 @@ void AKobWarCharacter::DodgePressed()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_Dodge, true);
+
 	OnDodgeButton.Broadcast(true, false);
 }
 
@@ -285,6 +593,8 @@ void AKobWarCharacter::DodgeReleased()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_Dodge, false);
+
 	OnDodgeButton.Broadcast(false, true);
 }
 
@@ -357,6 +667,8 @@ void AKobWarCharacter::LockOnPressed()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_LockOn, true);
+
 	OnLockOnButton.Broadcast(true, false);
 }
 
@@ -365,6 +677,8 @@ void AKobWarCharacter::LockOnReleased()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_LockOn, false);
+
 	OnLockOnButton.Broadcast(false, true);
 }
 
@@ -373,6 +687,8 @@ void AKobWarCharacter::AttackLightPressed()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_LightAttack, true);
+
 	OnAttackLightButton.Broadcast(true, false);
 }
 
@@ -381,6 +697,8 @@ void AKobWarCharacter::AttackLightReleased()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_LightAttack, false);
+
 	OnAttackLightButton.Broadcast(false, true);
 }
 
@@ -389,6 +707,8 @@ void AKobWarCharacter::AttackHeavyPressed()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_HeavyAttack, true);
+
 	OnAttackHeavyButton.Broadcast(true, false);
 }
 
@@ -397,6 +717,8 @@ void AKobWarCharacter::AttackHeavyReleased()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_HeavyAttack, false);
+
 	OnAttackHeavyButton.Broadcast(false, true);
 }
 
@@ -405,6 +727,8 @@ void AKobWarCharacter::BlockPressed()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_Block, true);
+
 	OnBlockButton.Broadcast(true, false);
 }
 
@@ -413,6 +737,8 @@ void AKobWarCharacter::BlockReleased()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_Block, false);
+
 	OnBlockButton.Broadcast(false, true);
 }
 
@@ -421,6 +747,8 @@ void AKobWarCharacter::InteractPressed()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_Interact, true);
+
 	OnInteractButton.Broadcast(true, false);
 }
 
@@ -429,6 +757,8 @@ void AKobWarCharacter::InteractReleased()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_Interact, false);
+
 	OnInteractButton.Broadcast(false, true);
 }
 
@@ -437,6 +767,8 @@ void AKobWarCharacter::UseItemPressed()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_UseItem, true);
+
 	OnUseItemButton.Broadcast(false, true);
 }
 
@@ -445,6 +777,8 @@ void AKobWarCharacter::UseItemReleased()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_UseItem, false);
+
 	OnUseItemButton.Broadcast(true, false);
 }
 
@@ -453,6 +787,8 @@ void AKobWarCharacter::WeaponSkillPressed()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_WeaponSkill, true);
+
 	OnWeaponSkill.Broadcast(true, false);
 }
 
@@ -461,6 +797,8 @@ void AKobWarCharacter::WeaponSkillReleased()
 	if (AreInputsPausedForMenu)
 		return;
 
+	SetLocalInputButton(ICB_WeaponSkill, false);
+
 	OnWeaponSkill.Broadcast(false, true);
 }
 
@@ -548,8 +886,10 @@ void AKobWarCharacter::LookDirUpdated(FVector2D& NormalizedInputVector, float& M
 
 FVector2D AKobWarCharacter::GetCurrentMovementInput()
 {
-	float xVal = GetInputAxisValue("MoveForward");
-	float yVal = GetInputAxisValue("MoveRight");
+	// remote clients' input only exists on the server through the batched input command
+	const bool useServerInput = HasReceivedInputCommand && !IsLocallyControlled();
+	float xVal = useServerInput ? ServerMoveInput.X : GetInputAxisValue("MoveForward");
+	float yVal = useServerInput ? ServerMoveInput.Y : GetInputAxisValue("MoveRight");
 	FVector2D vector = FVector2D(xVal, yVal);
 	float magnitude = vector.Size();
 
@@ -563,6 +903,11 @@ FVector2D AKobWarCharacter::GetCurrentMovementInput()
 
 FVector2D AKobWarCharacter::GetCurrentViewInput()
 {
+	if (HasReceivedInputCommand && !IsLocallyControlled())
+	{
+		return ServerViewInput;
+	}
+
 	float xVal = FMath::Clamp(GetInputAxisValue("TurnRate") + GetInputAxisValue("Turn"), -1.0f, 1.0f);
 	float yVal = FMath::Clamp(-GetInputAxisValue("LookUpRate") - GetInputAxisValue("LookUp"), -1.0f, 1.0f);
 	FVector2D vector = FVector2D(xVal, yVal);
@@ -583,6 +928,131 @@ FVector2D AKobWarCharacter::GetActorDirectionalVelocity()
 	return FVector2D(ForwardVelocity, RightVelocity);
 }
 
+namespace
+{
+	struct FInputCommandButtonBinding
+	{
+		EInputCommandButton Button;
+		void (AKobWarCharacter::*Pressed)();
+		void (AKobWarCharacter::*Released)();
+	};
+
+	int8 QuantizeInputAxis(float Value)
+	{
+		return (int8)FMath::RoundToInt(FMath::Clamp(Value, -1.0f, 1.0f) * 127.0f);
+	}
+
+	float DequantizeInputAxis(int8 Value)
+	{
+		return Value / 127.0f;
+	}
+
+	/* Sequence comparison that survives the 16 bit frame counter wrapping */
+	bool IsNewerInputFrame(uint16 Frame, uint16 LastFrame)
+	{
+		return (int16)(Frame - LastFrame) > 0;
+	}
+}
+
+void AKobWarCharacter::SetLocalInputButton(EInputCommandButton Button, bool Pressed)
+{
+	if (Pressed)
+	{
+		LocalButtonState |= Button;
+	}
+	else
+	{
+		LocalButtonState &= ~Button;
+	}
+}
+
+void AKobWarCharacter::SendInputCommand()
+{
+	const FVector2D viewInput = GetCurrentViewInput();
+
+	FInputCommandStruct command;
+	command.Frame = ++LocalInputFrame;
+	command.Buttons = LocalButtonState;
+	command.MoveForward = QuantizeInputAxis(PrevForwardInput);
+	command.MoveRight = QuantizeInputAxis(PrevRightInput);
+	command.LookX = QuantizeInputAxis(viewInput.X);
+	command.LookY = QuantizeInputAxis(viewInput.Y);
+
+	InputCommandHistory.Add(command);
+	const int32 redundancy = FMath::Clamp<int32>(InputCommandRedundancy, 1, 8);
+	if (InputCommandHistory.Num() > redundancy)
+	{
+		InputCommandHistory.RemoveAt(0, InputCommandHistory.Num() - redundancy, false);
+	}
+
+	ServerReceiveInputCommands(InputCommandHistory);
+}
+
+void AKobWarCharacter::ServerReceiveInputCommands_Implementation(const TArray<FInputCommandStruct>& Commands)
+{
+	if (!UseBatchedInputCommands || Commands.Num() > 8)
+		return;
+
+	// oldest first - anything already applied is a redundant copy
+	for (const FInputCommandStruct& command : Commands)
+	{
+		if (!HasReceivedInputCommand || IsNewerInputFrame(command.Frame, LastServerInputFrame))
+		{
+			ApplyInputCommand(command);
+			LastServerInputFrame = command.Frame;
+			HasReceivedInputCommand = true;
+		}
+	}
+}
+
+void AKobWarCharacter::ApplyInputCommand(const FInputCommandStruct& Command)
+{
+	static const FInputCommandButtonBinding buttonBindings[] =
+	{
+		{ ICB_LightAttack, &AKobWarCharacter::AttackLightPressed, &AKobWarCharacter::AttackLightReleased },
+		{ ICB_HeavyAttack, &AKobWarCharacter::AttackHeavyPressed, &AKobWarCharacter::AttackHeavyReleased },
+		{ ICB_Dodge, &AKobWarCharacter::DodgePressed, &AKobWarCharacter::DodgeReleased },
+		{ ICB_Block, &AKobWarCharacter::BlockPressed, &AKobWarCharacter::BlockReleased },
+		{ ICB_LockOn, &AKobWarCharacter::LockOnPressed, &AKobWarCharacter::LockOnReleased },
+		{ ICB_WeaponSkill, &AKobWarCharacter::WeaponSkillPressed, &AKobWarCharacter::WeaponSkillReleased },
+		{ ICB_Interact, &AKobWarCharacter::InteractPressed, &AKobWarCharacter::InteractReleased },
+		{ ICB_UseItem, &AKobWarCharacter::UseItemPressed, &AKobWarCharacter::UseItemReleased },
+	};
+
+	// axes first so the button consumers (e.g. dodge direction) read this frame's movement
+	const FVector2D moveInput(DequantizeInputAxis(Command.MoveForward), DequantizeInputAxis(Command.MoveRight));
+	if (moveInput.X != ServerMoveInput.X)
+	{
+		OnMoveUp.Broadcast(moveInput.X);
+	}
+	if (moveInput.Y != ServerMoveInput.Y)
+	{
+		OnMoveRight.Broadcast(moveInput.Y);
+	}
+	ServerMoveInput = moveInput;
+
+	const FVector2D viewInput(DequantizeInputAxis(Command.LookX), DequantizeInputAxis(Command.LookY));
+	if (viewInput != ServerViewInput)
+	{
+		OnLookDir.Broadcast(viewInput.GetSafeNormal(), viewInput.Size());
+	}
+	ServerViewInput = viewInput;
+
+	const uint16 changedButtons = Command.Buttons ^ ServerButtonState;
+	ServerButtonState = Command.Buttons;
+
+	if (changedButtons == 0)
+		return;
+
+	for (const FInputCommandButtonBinding& binding : buttonBindings)
+	{
+		if (changedButtons & binding.Button)
+		{
+			(this->*((Command.Buttons & binding.Button) ? binding.Pressed : binding.Released))();
+		}
+	}
+}
+
 void AKobWarCharacter::SetPausedInputsForMenu(bool Pause)
 {
 	AreInputsPausedForMenu = Pause;
@@ -73,6 +73,48 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FSetTeam, uint8, NewTeam);
 
 #pragma endregion
 
+#pragma region Input Command
+
+/* Button bits packed into FInputCommandStruct::Buttons */
+enum EInputCommandButton : uint16
+{
+	ICB_LightAttack		= 1 << 0,
+	ICB_HeavyAttack		= 1 << 1,
+	ICB_Dodge			= 1 << 2,
+	ICB_Block			= 1 << 3,
+	ICB_LockOn			= 1 << 4,
+	ICB_WeaponSkill		= 1 << 5,
+	ICB_Interact		= 1 << 6,
+	ICB_UseItem			= 1 << 7,
+};
+
+/* One frame of packed input sent from the owning client to the server. Axes are quantized to -127..127. */
+USTRUCT()
+struct FInputCommandStruct
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint16 Frame = 0;
+
+	UPROPERTY()
+	uint16 Buttons = 0;
+
+	UPROPERTY()
+	int8 MoveForward = 0;
+
+	UPROPERTY()
+	int8 MoveRight = 0;
+
+	UPROPERTY()
+	int8 LookX = 0;
+
+	UPROPERTY()
+	int8 LookY = 0;
+};
+
+#pragma endregion
+
 #pragma region State Delegate Declarations
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FStateChange, TEnumAsByte<ECharacterState>, NewState, TEnumAsByte<ECharacterState>, OldState);
@@ -87,13 +129,13 @@ class AKobWarCharacter : public AClientAuthoritativeCharacter
 {
 	GENERATED_BODY()
 
-	/** Camera boom positioning the camera behind the character */
+	/** Camera boom positioning the camera behind the character. Null on dedicated servers. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	class USpringArmComponent* CameraBoom;
+	class USpringArmComponent* CameraBoom = nullptr;
 
-	/** Follow camera */
+	/** Follow camera. Null on dedicated servers. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	class UCameraComponent* FollowCamera;
+	class UCameraComponent* FollowCamera = nullptr;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Actions", meta = (AllowPrivateAccess = "true"))
 	class UActionControlComponent* ActionControl;
@@ -102,7 +144,10 @@ class AKobWarCharacter : public AClientAuthoritativeCharacter
 	class ULockOnTargSceneComponent* LockOnTargetComponent;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Actions", meta = (AllowPrivateAccess = "true"))
-	class USoundPlayerComponent* SoundComponent;
+	class USoundPlayerComponent* SoundComponent = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Network", meta = (AllowPrivateAccess = "true"))
+	class UMovementSnapshotComponent* MovementSnapshot;
 
 protected:
 
@@ -127,6 +172,36 @@ protected:
 
 #pragma endregion
 
+#pragma region Input Command
+
+	/* When true, the owning client sends one packed input command per frame and the server re-broadcasts the input delegates from it.
+	   Blueprints that forward individual inputs to the server should drop those RPCs when this is enabled. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
+	bool UseBatchedInputCommands = false;
+
+	/* Number of recent commands resent with every packet so a lost packet doesn't lose a press or release */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ClampMin = "1", ClampMax = "8"))
+	uint8 InputCommandRedundancy = 3;
+
+	uint16 LocalButtonState = 0;
+
+	uint16 LocalInputFrame = 0;
+
+	TArray<FInputCommandStruct> InputCommandHistory = TArray<FInputCommandStruct>();
+
+	/* Server side state of the remote client's input */
+	uint16 ServerButtonState = 0;
+
+	uint16 LastServerInputFrame = 0;
+
+	bool HasReceivedInputCommand = false;
+
+	FVector2D ServerMoveInput = FVector2D::ZeroVector;
+
+	FVector2D ServerViewInput = FVector2D::ZeroVector;
+
+#pragma endregion
+
 
 public:
 
@@ -217,6 +292,12 @@ public:
 
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 #pragma region Possession
 
 	virtual void PossessedBy(AController* NewController) override;
@@ -419,12 +500,39 @@ protected:
 
 #pragma endregion
 
+#pragma region Input Command
+
+	void SetLocalInputButton(EInputCommandButton Button, bool Pressed);
+
+	/* Packs this frame's input and sends it with the last few commands */
+	void SendInputCommand();
+
+	UFUNCTION(Server, Unreliable)
+	void ServerReceiveInputCommands(const TArray<FInputCommandStruct>& Commands);
+
+	/* Re-broadcasts the input delegates for every button and axis that changed since the last applied command */
+	void ApplyInputCommand(const FInputCommandStruct& Command);
+
+#pragma endregion
+
 #pragma region Movement
 
 	/* Updates the character speed based on all current data */
 	UFUNCTION(BlueprintCallable)
 	void UpdateSpeed();
 
+public:
+
+	/* Walk speed the current aiming/stealth/running state allows. Also used by the server movement validation. */
+	UFUNCTION(BlueprintCallable)
+	float GetTargetMoveSpeed() const;
+
+	/* Sent by the server movement validation when the client's reported position was rejected */
+	UFUNCTION(Client, Reliable)
+	void ClientCorrectPosition(FVector_NetQuantize Location);
+
+protected:
+
 #pragma endregion
 
 public:
@@ -487,6 +595,89 @@ public:
 
 #pragma endregion
 
+#pragma region Pooling
+
+	/* Server only - unpossesses, resets every component and hides the character so the game mode can reuse it */
+	void DeactivateForPool();
+
+	/* Server only - moves a pooled character to the spawn transform and makes it active again */
+	void ActivateFromPool(const FTransform& SpawnTransform, const uint8 TeamId);
+
+	UFUNCTION(BlueprintCallable)
+	bool IsInPawnPool() const;
+
+	/* Called on every machine when the character enters the pool. Blueprint children reset their own state here (health, equipment, materials) */
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnResetForPool();
+
+protected:
+
+	/* Hidden, collision, ticking and the reset contract - the server applies it directly, clients from OnRep_IsPooled */
+	void ApplyPooledState();
+
+	UFUNCTION()
+	void OnRep_IsPooled();
+
+	/* Reset contract - action state, stealth, climb state, lock-on, team and local character state */
+	void ResetComponentsForPool();
+
+	/* Stops every component tick while pooled and restores the ones that were running */
+	void SetComponentTicksPooled(bool Pooled);
+
+	/* Local players locked on to this character let go */
+	void ReleaseLocalLockOns();
+
+	/* Replicated rather than multicast so late joiners and clients the character wasn't relevant to still get it */
+	UPROPERTY(ReplicatedUsing = OnRep_IsPooled)
+	bool IsPooled = false;
+
+	UPROPERTY()
+	TArray<UActorComponent*> PooledTickingComponents;
+
+public:
+
+#pragma endregion
+
+#pragma region Network Priority
+
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, class AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
+	/* While stealthed, only relevant to viewers whose pawn has at least StealthRelevantDetection on this character */
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+	/* Ignored while the movement snapshot component positions this simulated proxy */
+	virtual void OnRep_ReplicatedMovement() override;
+
+	/* Server only - counts players locked on to this character and raises its update rate while any are */
+	void AddLockOnWatcher(bool Add);
+
+protected:
+
+	uint8 LockOnWatcherCount = 0;
+
+public:
+
+	/* Net priority multiplier for the connection whose player is locked on to this character */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
+	float LockedOnNetPriorityScale = 4.0f;
+
+	/* NetUpdateFrequency while at least one player is locked on */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
+	float LockedOnNetUpdateFrequency = 100.0f;
+
+	/* With saturated bandwidth, characters further than this from a viewer who isn't locked on to them drop in priority */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
+	float DistantNetPriorityRange = 3000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
+	float DistantNetPriorityScale = 0.5f;
+
+	/* Detection a viewer needs before this stealthed character is replicated to them. 0 keeps stealthed characters always relevant */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
+	float StealthRelevantDetection = 0.05f;
+
+#pragma endregion
+
 
 #pragma region Getters
 
@@ -512,5 +703,7 @@ public:
 
 	FORCEINLINE class USoundPlayerComponent* GetSoundPlayer() const { return SoundComponent; }
 
+	FORCEINLINE class UMovementSnapshotComponent* GetMovementSnapshot() const { return MovementSnapshot; }
+
 };
 
@@ -14,6 +14,18 @@ AKobWarGameMode::AKobWarGameMode()
 	}
 }
 
+void AKobWarGameMode::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// a listen server host's PostLogin runs before BeginPlay, so this can't wait for it. Not in the constructor either -
+	// the CDO's binding to itself would be copied into every Blueprint game mode
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		OnPlayerSetToTeam.AddUniqueDynamic(this, &AKobWarGameMode::RecordPlayerTeam);
+	}
+}
+
 void AKobWarGameMode::BeginPlay()
 {
 	Super::BeginPlay();
@@ -31,6 +43,8 @@ void AKobWarGameMode::PostLogin(APlayerController* NewPlayer)
 
 void AKobWarGameMode::Logout(AController* Exiting)
 {
+	RemovePlayerFromTeams(Exiting);
+
 	Super::Logout(Exiting);
 
 	OnPlayerDisconnect.Broadcast(Exiting);
@@ -48,6 +62,11 @@ void AKobWarGameMode::InitGameStartTimer()
 
 void AKobWarGameMode::InitNewRoundStartTimer()
 {
+	if (IsTeamBased && SwitchSidesEachRound)
+	{
+		SwitchAttackingSides();
+	}
+
 	GetWorld()->GetTimerManager().SetTimer(PreGameTimer, this, &AKobWarGameMode::TriggerGameStartEvent, NewRoundWaitTime);
 }
 
@@ -75,50 +94,188 @@ void AKobWarGameMode::InitRespawnTimer()
 	GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &AKobWarGameMode::TriggerRespawnEvent, RespawnTime, true);
 }
 
-//bool AKobWarGameMode::SetPlayerTeam(APlayerController* Player, uint8 Team, bool ForceSwitch = false)
-//{
-//
-//	if (PlayerControllers.Num() == 0)
-//	{
-//		return false;
-//	}
-//
-//	switch (Team)
-//	{
-//	case (1):
-//
-//		if (PlayerControllers_Team1.Num() == 0)
-//		{
-//			OnPlayerSetToTeam.Broadcast(Player, Team);
-//			return true;
-//		}
-//
-//		if ((float)(PlayerControllers_Team1.Num() + 1) / (PlayerControllers.Num()) <= TeamRatio || ForceSwitch)
-//		{
-//			if (PlayerControllers_Team2.Contains(Player))
-//				PlayerControllers_Team2.Remove(Player);
-//			PlayerControllers_Team1.Add(Player);
-//			OnPlayerSetToTeam.Broadcast(Player, Team);
-//			return true;
-//		}
-//		return false;
-//
-//	case (2):
-//
-//		if (PlayerControllers_Team2.Num() == 0) {
-//			OnPlayerSetToTeam.Broadcast(Player, Team);
-//			return true;
-//		}
-//
-//		if ((float)(PlayerControllers_Team2.Num() + 1) / (PlayerControllers.Num()) <= (1 - TeamRatio) || ForceSwitch)
-//		{
-//			if (PlayerControllers_Team1.Contains(Player))
-//				PlayerControllers_Team1.Remove(Player);
-//			PlayerControllers_Team2.Add(Player);
-//			OnPlayerSetToTeam.Broadcast(Player, Team);
-//			return true;
-//		}
-//		return false;
-//	}
-//	return false;
-//}
+AKobWarCharacter* AKobWarGameMode::SpawnOrReusePawn(TSubclassOf<AKobWarCharacter> PawnClass, const FTransform& SpawnTransform, uint8 TeamId)
+{
+	if (!PawnClass)
+		return nullptr;
+
+	if (UsePawnPool)
+	{
+		if (FPawnPoolStruct* pool = PawnPools.Find(PawnClass.Get()))
+		{
+			while (pool->InactivePawns.Num() > 0)
+			{
+				AKobWarCharacter* pooledPawn = pool->InactivePawns.Pop(false);
+				if (IsValid(pooledPawn))
+				{
+					pooledPawn->ActivateFromPool(SpawnTransform, TeamId);
+					return pooledPawn;
+				}
+			}
+		}
+	}
+
+	return SpawnPooledPawn(PawnClass, SpawnTransform, TeamId);
+}
+
+void AKobWarGameMode::ReleasePawnToPool(AKobWarCharacter* Pawn)
+{
+	if (!IsValid(Pawn) || Pawn->IsInPawnPool())
+		return;
+
+	FPawnPoolStruct& pool = PawnPools.FindOrAdd(Pawn->GetClass());
+	if (!UsePawnPool || pool.InactivePawns.Num() >= MaxPooledPawnsPerClass)
+	{
+		Pawn->Destroy();
+		return;
+	}
+
+	Pawn->DeactivateForPool();
+	pool.InactivePawns.Add(Pawn);
+}
+
+void AKobWarGameMode::PrewarmPawnPool(TSubclassOf<AKobWarCharacter> PawnClass, int32 Count)
+{
+	if (!PawnClass || !UsePawnPool)
+		return;
+
+	FPawnPoolStruct& pool = PawnPools.FindOrAdd(PawnClass.Get());
+	const int32 toSpawn = FMath::Min<int32>(Count, MaxPooledPawnsPerClass) - pool.InactivePawns.Num();
+
+	for (int32 i = 0; i < toSpawn; i++)
+	{
+		if (AKobWarCharacter* pawn = SpawnPooledPawn(PawnClass, FTransform(FVector(0.0f, 0.0f, -10000.0f)), ETeam::Spectating))
+		{
+			pawn->DeactivateForPool();
+			pool.InactivePawns.Add(pawn);
+		}
+	}
+}
+
+AKobWarCharacter* AKobWarGameMode::SpawnPooledPawn(TSubclassOf<AKobWarCharacter> PawnClass, const FTransform& SpawnTransform, uint8 TeamId)
+{
+	AKobWarCharacter* pawn = GetWorld()->SpawnActorDeferred<AKobWarCharacter>(PawnClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (!pawn)
+		return nullptr;
+
+	pawn->GenericTeamId = TeamId;
+	pawn->FinishSpawning(SpawnTransform);
+	return pawn;
+}
+
+bool AKobWarGameMode::AssignPlayerTeam(APlayerController* Player, uint8 Team, bool ForceSwitch)
+{
+	if (!Player || Team > ETeam::NeutralTeam)
+		return false;
+
+	const uint8* currentTeam = PlayerTeams.Find(Player);
+	if (currentTeam && *currentTeam == Team)
+		return true;
+
+	if (!ForceSwitch && !CanJoinTeam(Player, Team))
+		return false;
+
+	RecordPlayerTeam(Player, Team);
+	OnPlayerSetToTeam.Broadcast(Player, Team);
+	return true;
+}
+
+void AKobWarGameMode::RecordPlayerTeam(APlayerController* Player, uint8 Team)
+{
+	if (!Player || Team > ETeam::NeutralTeam)
+		return;
+
+	if (uint8* currentTeam = PlayerTeams.Find(Player))
+	{
+		if (*currentTeam == Team)
+			return;
+
+		TeamCounts[*currentTeam]--;
+		*currentTeam = Team;
+	}
+	else
+	{
+		PlayerTeams.Add(Player, Team);
+	}
+
+	TeamCounts[Team]++;
+}
+
+void AKobWarGameMode::RemovePlayerFromTeams(AController* Player)
+{
+	uint8 team;
+	if (PlayerTeams.RemoveAndCopyValue(Cast<APlayerController>(Player), team))
+	{
+		TeamCounts[team]--;
+	}
+}
+
+bool AKobWarGameMode::CanJoinTeam(APlayerController* Player, uint8 Team) const
+{
+	if (!Player || Team > ETeam::NeutralTeam)
+		return false;
+
+	const uint8* currentTeam = PlayerTeams.Find(Player);
+	if (currentTeam && *currentTeam == Team)
+		return true;
+
+	if (Team == ETeam::Spectating)
+		return TeamCounts[ETeam::Spectating] < MaxSpectators;
+
+	if (Team == ETeam::NeutralTeam)
+		return !IsTeamBased;
+
+	if (!IsTeamBased || TeamCounts[Team] >= MaxAmountPlayersPerTeam)
+		return false;
+
+	const bool isOnPlayingTeam = currentTeam && (*currentTeam == ETeam::Team_1 || *currentTeam == ETeam::Team_2);
+	if (isOnPlayingTeam && !AllowTeamSwitching)
+		return false;
+
+	// a switch keeps the playing total the same, a join adds one
+	const int32 totalPlayers = TeamCounts[ETeam::Team_1] + TeamCounts[ETeam::Team_2] + (isOnPlayingTeam ? 0 : 1);
+	const bool withinRatio = TeamCounts[Team] + 1 <= GetTeamRatioLimit(Team, totalPlayers);
+
+	if (isOnPlayingTeam && AllowInbalancedTeamSwitching)
+		return true;
+
+	return withinRatio;
+}
+
+int32 AKobWarGameMode::GetTeamRatioLimit(uint8 Team, int32 TotalPlayers) const
+{
+	const float share = Team == ETeam::Team_1 ? TeamRatio : 1.0f - TeamRatio;
+	return FMath::Max(1, FMath::CeilToInt(share * TotalPlayers - KINDA_SMALL_NUMBER));
+}
+
+uint8 AKobWarGameMode::PickBalancedTeam() const
+{
+	const int32 totalPlayers = TeamCounts[ETeam::Team_1] + TeamCounts[ETeam::Team_2] + 1;
+	const float team1Deficit = TeamRatio * totalPlayers - TeamCounts[ETeam::Team_1];
+	const float team2Deficit = (1.0f - TeamRatio) * totalPlayers - TeamCounts[ETeam::Team_2];
+
+	if (TeamCounts[ETeam::Team_1] >= MaxAmountPlayersPerTeam)
+		return TeamCounts[ETeam::Team_2] < MaxAmountPlayersPerTeam ? ETeam::Team_2 : ETeam::Spectating;
+
+	if (TeamCounts[ETeam::Team_2] >= MaxAmountPlayersPerTeam)
+		return ETeam::Team_1;
+
+	return team2Deficit > team1Deficit ? ETeam::Team_2 : ETeam::Team_1;
+}
+
+bool AKobWarGameMode::GetPlayerTeam(APlayerController* Player, uint8& OutTeam) const
+{
+	const uint8* team = PlayerTeams.Find(Player);
+	OutTeam = team ? *team : (uint8)ETeam::Spectating;
+	return team != nullptr;
+}
+
+int32 AKobWarGameMode::GetTeamCount(uint8 Team) const
+{
+	return Team <= ETeam::NeutralTeam ? TeamCounts[Team] : 0;
+}
+
+void AKobWarGameMode::SwitchAttackingSides()
+{
+	Swap(IsBlackTeamAttacking, IsWhiteTeamAttacking);
+}
@@ -6,6 +6,9 @@
 #include "GameFramework/GameMode.h"
 #include "KobWarGameMode.generated.h"
 
+class AGamePlayerController;
+class AKobWarCharacter;
+
 UENUM(BlueprintType)
 enum ETeam
 {
@@ -32,6 +35,17 @@ public:
 	TArray<FName> Equipment = TArray<FName>();
 };
 
+USTRUCT()
+struct FPawnPoolStruct
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY()
+	TArray<AKobWarCharacter*> InactivePawns = TArray<AKobWarCharacter*>();
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FPlayerConnect, APlayerController*, NewPlayer);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FPlayerDisconnect, AController*, QuitPlayer);
 
@@ -51,6 +65,8 @@ class AKobWarGameMode : public AGameMode
 public:
 	AKobWarGameMode();
 
+	virtual void PostInitProperties() override;
+
 	virtual void BeginPlay() override;
 
 	virtual void PostLogin(APlayerController* NewPlayer) override;
@@ -118,7 +134,7 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category = "Teams", meta = (EditCondition = "IsTeamBased"))
 	bool AllowTeamSwitching = true;
 
-	// When true, the player can only switch teams when the other team has fewer players than the TeamRatio prefers.
+	// When false, the player can only switch teams when the other team has fewer players than the TeamRatio prefers.
 	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category = "Teams", meta = (EditCondition = "IsTeamBased && AllowTeamSwitching"))
 	bool AllowInbalancedTeamSwitching = true;
 
@@ -126,7 +142,7 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category = "Teams", meta = (EditCondition = "IsTeamBased"))
 	TArray<FPlayableClassStruct> OtherTeamPlayableClasses = TArray<FPlayableClassStruct>();
 
-	// True if players should switch sides after each round. For assymetrical modes.
+	// True if the teams should switch attacking and defending sides after each round. For assymetrical modes.
 	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category = "Teams", meta = (EditCondition = "IsTeamBased"))
 	bool SwitchSidesEachRound = false;
 
@@ -141,6 +157,49 @@ public:
 
 	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category = "Teams", meta = (EditCondition = "IsTeamBased"))
 	bool IsTeam2AttackingFirst = false;
+
+	/* Native team registry entry point - moves Player to Team when the team rules allow it, or always with ForceSwitch.
+	   Broadcasts OnPlayerSetToTeam on a change. The Blueprint SetPlayerTeam should call this instead of keeping its own lists */
+	UFUNCTION(BlueprintCallable, Category = "Teams")
+	bool AssignPlayerTeam(APlayerController* Player, uint8 Team, bool ForceSwitch);
+
+	/* True when AssignPlayerTeam would accept the move without ForceSwitch */
+	UFUNCTION(BlueprintPure, Category = "Teams")
+	bool CanJoinTeam(APlayerController* Player, uint8 Team) const;
+
+	/* The playing team furthest below its TeamRatio share, Team_1 on a tie */
+	UFUNCTION(BlueprintPure, Category = "Teams")
+	uint8 PickBalancedTeam() const;
+
+	/* False when Player hasn't been put on a team yet */
+	UFUNCTION(BlueprintPure, Category = "Teams")
+	bool GetPlayerTeam(APlayerController* Player, uint8& OutTeam) const;
+
+	UFUNCTION(BlueprintPure, Category = "Teams")
+	int32 GetTeamCount(uint8 Team) const;
+
+	/* Swaps which team attacks. Team membership, and with it each player's class list, stays the same. Runs at each new round when SwitchSidesEachRound is set */
+	UFUNCTION(BlueprintCallable, Category = "Teams")
+	void SwitchAttackingSides();
+
+	/* Drops Player from the registry. Called from Logout */
+	void RemovePlayerFromTeams(AController* Player);
+
+protected:
+
+	/* Keeps the registry in step with every OnPlayerSetToTeam broadcast, including ones from Blueprint team logic */
+	UFUNCTION()
+	void RecordPlayerTeam(APlayerController* Player, uint8 Team);
+
+	/* Most players Team may hold out of TotalPlayers on the playing teams under TeamRatio */
+	int32 GetTeamRatioLimit(uint8 Team, int32 TotalPlayers) const;
+
+	UPROPERTY()
+	TMap<APlayerController*, uint8> PlayerTeams;
+
+	int32 TeamCounts[ETeam::NeutralTeam + 1] = {};
+
+public:
 	
 #pragma endregion
 
@@ -223,6 +282,39 @@ public:
 
 #pragma endregion
 
+#pragma region Pawn Pool
+
+	// When true, dead characters are reset and reused on respawn instead of being destroyed and spawned again
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category = "Respawn")
+	bool UsePawnPool = true;
+
+	// Inactive characters kept per class. Extra released characters are destroyed.
+	UPROPERTY(BlueprintReadWrite, EditDefaultsOnly, Category = "Respawn", meta = (EditCondition = "UsePawnPool"))
+	uint8 MaxPooledPawnsPerClass = 8;
+
+	// Returns a pooled character of this class moved to the spawn transform, or spawns a new one when the pool is empty. The caller possesses it.
+	UFUNCTION(BlueprintCallable, Category = "Respawn", meta = (DeterminesOutputType = "PawnClass"))
+	AKobWarCharacter* SpawnOrReusePawn(TSubclassOf<AKobWarCharacter> PawnClass, const FTransform& SpawnTransform, uint8 TeamId);
+
+	// Use instead of destroying a dead character
+	UFUNCTION(BlueprintCallable, Category = "Respawn")
+	void ReleasePawnToPool(AKobWarCharacter* Pawn);
+
+	// Spawns inactive characters up front so the first respawn wave doesn't construct them
+	UFUNCTION(BlueprintCallable, Category = "Respawn")
+	void PrewarmPawnPool(TSubclassOf<AKobWarCharacter> PawnClass, int32 Count);
+
+protected:
+
+	UPROPERTY()
+	TMap<UClass*, FPawnPoolStruct> PawnPools;
+
+	AKobWarCharacter* SpawnPooledPawn(TSubclassOf<AKobWarCharacter> PawnClass, const FTransform& SpawnTransform, uint8 TeamId);
+
+public:
+
+#pragma endregion
+
 };
 
 
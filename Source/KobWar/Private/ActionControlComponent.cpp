@@ -3,6 +3,8 @@
 
 #include "ActionControlComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "ClimbingMesh.h"
+#include "KobWarQuerySubsystem.h"
 
 // Sets default values for this component's properties
 UActionControlComponent::UActionControlComponent()
@@ -163,6 +165,38 @@ FName UActionControlComponent::GetCurrentAction()
 	return CurrentAction;
 }
 
+void UActionControlComponent::ResetForPool()
+{
+	if (UWorld* world = GetWorld())
+	{
+		FTimerManager& timerManager = world->GetTimerManager();
+		timerManager.ClearTimer(ActionTimer);
+		timerManager.ClearTimer(UntilComboTimer);
+		timerManager.ClearTimer(DodgeThresholdTimer);
+		for (FTimerHandle& eventTimer : EventTimers)
+		{
+			timerManager.ClearTimer(eventTimer);
+		}
+	}
+	EventTimers.Empty();
+	ClearActionQueue();
+
+	CurrentAction = NullAction;
+	CurrentActionComboIndex = 0;
+	IsAllowingComboAction = false;
+	IsDodgeReleaseThreshold = false;
+	IsLightHeld = false;
+	IsHeavyHeld = false;
+	IsDodgeHeld = false;
+	IsWeaponSkillHeld = false;
+	SetNotChargingActions();
+	IsSpecialLightActionReady = false;
+	IsSpecialHeavyActionReady = false;
+	IsAiming = false;
+	IsClimbing = false;
+	CurrentClimbingMesh = nullptr;
+}
+
 bool UActionControlComponent::TriggerLightAttack()
 {
 	UE_LOG(LogTemp, Warning, TEXT("UActionControlComponent::TriggerLightAttack"));
@@ -440,6 +474,9 @@ void UActionControlComponent::ActionEnd()
 	FName prevAction = CurrentAction;
 	CurrentAction = FName("?");
 
+	// the climber is still until the next climb input, so its answers will be waiting for it
+	RequestClimbTraces();
+
 	OnActionEnd.Broadcast(prevAction);
 
 	if (auto* movementComp = OwnerCharacter->GetCharacterMovement())
@@ -841,36 +878,34 @@ void UActionControlComponent::SetAiming(bool Toggle)
 void UActionControlComponent::SetIsClimbing(bool Toggle)
 {
 	IsClimbing = Toggle;
+	RequestClimbTraces();
 }
 
-bool UActionControlComponent::TraceCheckIfClimbingAtTop()
+void UActionControlComponent::SetClimbingMesh(AClimbingMesh* ClimbingMesh)
 {
-	FVector start = OwnerCharacter->GetActorLocation() + FVector(0,0,66); 
-	FRotator rot = OwnerCharacter->GetActorRotation();
-	FVector forwardVector = rot.Vector(); 
-
-	float TraceDistance = 100.0f;
+	CurrentClimbingMesh = ClimbingMesh;
+	RequestClimbTraces();
+}
 
-	FVector end = start + forwardVector * TraceDistance;
+bool UActionControlComponent::TraceCheckIfClimbingAtTop()
+{
+	if (CurrentClimbingMesh && CurrentClimbingMesh->HasBakedClimbData)
+	{
+		return CurrentClimbingMesh->IsAtClimbTop(OwnerCharacter->GetActorLocation() + FVector(0, 0, 66));
+	}
 
-	// Perform the line trace.
-	FHitResult HitResult;
-	FCollisionQueryParams CollisionParams;
-	CollisionParams.AddIgnoredActor(OwnerCharacter); 
+	FVector start;
+	FVector end;
+	GetClimbTopTrace(start, end);
 
-	// Perform the horizontal line trace.
-	bool bHit = GetWorld()->LineTraceSingleByChannel(
-		HitResult,
-		start,
-		end,
-		ECC_Visibility, 
-		CollisionParams
-	);
+	bool bHit = TraceClimbCheck(TEXT("ClimbTop"), start, end);
 
-	if (bHit)
-		DrawDebugLine(GetWorld(), start, end, FColor::Green, false, 1.f, 0, 1.f);
-	else 
-		DrawDebugLine(GetWorld(), start, end, FColor::Red, false, 1.f, 0, 1.f);
+#if ENABLE_DRAW_DEBUG && !UE_SERVER
+	if (DebugTrace)
+	{
+		DrawDebugLine(GetWorld(), start, end, bHit ? FColor::Green : FColor::Red, false, 1.f, 0, 1.f);
+	}
+#endif
 
 
 	return !bHit;
@@ -879,33 +914,78 @@ bool UActionControlComponent::TraceCheckIfClimbingAtTop()
 
 bool UActionControlComponent::TraceForFloorBelow()
 {
-	FVector start = OwnerCharacter->GetActorLocation();
+	if (CurrentClimbingMesh && CurrentClimbingMesh->HasBakedClimbData)
+	{
+		return CurrentClimbingMesh->IsAtClimbBottom(OwnerCharacter->GetActorLocation() - FVector(0, 0, 45.0f));
+	}
+
+	FVector start;
+	FVector end;
+	GetFloorBelowTrace(start, end);
+
+	bool bHit = TraceClimbCheck(TEXT("FloorBelow"), start, end);
+
+#if ENABLE_DRAW_DEBUG && !UE_SERVER
+	if (DebugTrace)
+	{
+		DrawDebugLine(GetWorld(), start, end, bHit ? FColor::Green : FColor::Red, false, 1.f, 0, 1.f);
+	}
+#endif
+
+
+	return bHit;
+}
+
+void UActionControlComponent::GetClimbTopTrace(FVector& OutStart, FVector& OutEnd) const
+{
+	OutStart = OwnerCharacter->GetActorLocation() + FVector(0, 0, 66);
+	OutEnd = OutStart + OwnerCharacter->GetActorRotation().Vector() * 100.0f;
+}
+
+void UActionControlComponent::GetFloorBelowTrace(FVector& OutStart, FVector& OutEnd) const
+{
+	OutStart = OwnerCharacter->GetActorLocation();
+	OutEnd = OutStart + FVector(0, 0, -45.0f);
+}
 
-	FVector TraceDistance = FVector(0, 0, -45.0f);
+void UActionControlComponent::RequestClimbTraces()
+{
+	if (!IsClimbing || !CurrentClimbingMesh || CurrentClimbingMesh->HasBakedClimbData)
+		return;
 
-	FVector end = start + TraceDistance;
+	auto* querySubsystem = GetWorld()->GetSubsystem<UKobWarQuerySubsystem>();
+	if (!querySubsystem)
+		return;
 
-	// Perform the line trace.
-	FHitResult HitResult;
-	FCollisionQueryParams CollisionParams;
-	CollisionParams.AddIgnoredActor(OwnerCharacter);
+	FKobWarQueryRequest query;
+	query.IgnoreActor = OwnerCharacter;
+	FKobWarQueryResult unused;
 
-	// Perform the horizontal line trace.
-	bool bHit = GetWorld()->LineTraceSingleByChannel(
-		HitResult,
-		start,
-		end,
-		ECC_Visibility,
-		CollisionParams
-	);
+	GetClimbTopTrace(query.Start, query.End);
+	querySubsystem->TraceLatest(OwnerCharacter, TEXT("ClimbTop"), query, unused);
 
-	if (bHit)
-		DrawDebugLine(GetWorld(), start, end, FColor::Green, false, 1.f, 0, 1.f);
-	else
-		DrawDebugLine(GetWorld(), start, end, FColor::Red, false, 1.f, 0, 1.f);
+	GetFloorBelowTrace(query.Start, query.End);
+	querySubsystem->TraceLatest(OwnerCharacter, TEXT("FloorBelow"), query, unused);
+}
 
+bool UActionControlComponent::TraceClimbCheck(FName Tag, const FVector& Start, const FVector& End)
+{
+	FKobWarQueryRequest query;
+	query.Start = Start;
+	query.End = End;
+	query.IgnoreActor = OwnerCharacter;
 
-	return bHit;
+	// answered from the traces queued when the last climb step ended, as long as the climber hasn't moved since
+	FKobWarQueryResult result;
+	auto* querySubsystem = GetWorld()->GetSubsystem<UKobWarQuerySubsystem>();
+	if (querySubsystem && querySubsystem->TraceLatest(OwnerCharacter, Tag, query, result) && FVector::DistSquared(result.Start, Start) <= FMath::Square(ClimbTraceTolerance))
+	{
+		return result.IsHit;
+	}
+
+	// nothing traced from here yet - the first input of a climb, or one made mid-step
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(ClimbCheck), false, OwnerCharacter);
+	return GetWorld()->LineTraceTestByChannel(Start, End, ECC_Visibility, queryParams);
 }
 
 
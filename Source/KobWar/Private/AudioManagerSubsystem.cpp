@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AudioManagerSubsystem.h"
+#include "Components/AudioComponent.h"
+#include "Sound/SoundBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+
+bool UAudioManagerSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* world = Cast<UWorld>(Outer);
+	return world && world->IsGameWorld() && !IsRunningDedicatedServer();
+}
+
+void UAudioManagerSubsystem::Deinitialize()
+{
+	for (UAudioComponent* audioComp : AudioPool)
+	{
+		if (audioComp)
+		{
+			audioComp->OnAudioFinishedNative.RemoveAll(this);
+			audioComp->DestroyComponent();
+		}
+	}
+
+	AudioPool.Empty();
+	PoolCategories.Empty();
+	PoolInUse.Empty();
+	PendingSounds.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UAudioManagerSubsystem::IsTickable() const
+{
+	return PendingSounds.Num() > 0 && GetWorld();
+}
+
+TStatId UAudioManagerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAudioManagerSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UAudioManagerSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+void UAudioManagerSubsystem::PlaySoundAtLocation(USoundBase* Sound, const FVector& Location, ESoundCategory Category, float Volume, float Pitch, float StartTime, float Priority)
+{
+	if (!Sound || Volume <= 0.0f)
+		return;
+
+	const float duplicateDistSq = FMath::Square(DuplicateDistance);
+	for (FPendingSound& pending : PendingSounds)
+	{
+		// two characters landing the same swing on one frame should sound like one hit, not a louder one
+		if (pending.Sound == Sound && FVector::DistSquared(pending.Location, Location) <= duplicateDistSq)
+		{
+			pending.Volume = FMath::Max(pending.Volume, Volume);
+			pending.Priority = FMath::Max(pending.Priority, Priority);
+			return;
+		}
+	}
+
+	FPendingSound& sound = PendingSounds.AddDefaulted_GetRef();
+	sound.Sound = Sound;
+	sound.Location = Location;
+	sound.Volume = Volume;
+	sound.Pitch = Pitch;
+	sound.StartTime = StartTime;
+	sound.Priority = Priority;
+	sound.Category = Category;
+}
+
+int32 UAudioManagerSubsystem::GetVoiceBudget(ESoundCategory Category) const
+{
+	switch (Category)
+	{
+	case ESoundCategory::Footstep:
+		return MaxFootstepVoices;
+	case ESoundCategory::Combat:
+		return MaxCombatVoices;
+	case ESoundCategory::Voice:
+		return MaxVoiceVoices;
+	default:
+		return MaxWorldVoices;
+	}
+}
+
+bool UAudioManagerSubsystem::GetListenerLocation(FVector& OutLocation) const
+{
+	APlayerController* playerController = GetWorld()->GetFirstPlayerController();
+	if (!playerController)
+		return false;
+
+	FVector frontDir;
+	FVector rightDir;
+	playerController->GetAudioListenerPosition(OutLocation, frontDir, rightDir);
+	return true;
+}
+
+void UAudioManagerSubsystem::Tick(float DeltaTime)
+{
+	TArray<FPendingSound> sounds = MoveTemp(PendingSounds);
+	PendingSounds.Reset();
+
+	FVector listenerLoc;
+	if (!GetListenerLocation(listenerLoc))
+		return;
+
+	// score what can be heard, drop the rest before the audio engine sees it
+	for (int32 i = sounds.Num() - 1; i >= 0; i--)
+	{
+		FPendingSound& sound = sounds[i];
+		const float maxDistance = sound.Sound->GetAttenuationSettingsToApply() ? sound.Sound->GetMaxDistance() : DefaultMaxDistance;
+		const float dist = FVector::Dist(listenerLoc, sound.Location);
+		if (dist >= maxDistance)
+		{
+			sounds.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		sound.Score = sound.Priority * sound.Volume * (1.0f - dist / maxDistance);
+	}
+
+	sounds.Sort([](const FPendingSound& A, const FPendingSound& B) { return A.Score > B.Score; });
+
+	for (const FPendingSound& sound : sounds)
+	{
+		const uint8 category = (uint8)sound.Category;
+		if (ActiveVoices[category] >= GetVoiceBudget(sound.Category))
+			continue;
+
+		const int32 poolIndex = AcquireAudioComponent();
+		if (poolIndex == INDEX_NONE)
+			return;
+
+		UAudioComponent* audioComp = AudioPool[poolIndex];
+		PoolCategories[poolIndex] = sound.Category;
+		PoolInUse[poolIndex] = true;
+		ActiveVoices[category]++;
+
+		audioComp->SetSound(sound.Sound);
+		audioComp->SetWorldLocation(sound.Location);
+		audioComp->SetVolumeMultiplier(sound.Volume);
+		audioComp->SetPitchMultiplier(sound.Pitch);
+		audioComp->Play(sound.StartTime);
+
+		// no audio device, playback disabled for the world or the sound failed - nothing will ever call OnAudioFinished
+		if (!audioComp->IsPlaying())
+		{
+			OnAudioFinished(audioComp);
+		}
+	}
+}
+
+int32 UAudioManagerSubsystem::AcquireAudioComponent()
+{
+	const int32 freeIndex = PoolInUse.IndexOfByKey(false);
+	if (freeIndex != INDEX_NONE)
+		return freeIndex;
+
+	AWorldSettings* worldSettings = GetWorld()->GetWorldSettings();
+	if (!worldSettings)
+		return INDEX_NONE;
+
+	UAudioComponent* audioComp = NewObject<UAudioComponent>(worldSettings);
+	audioComp->bAutoActivate = false;
+	audioComp->bAutoDestroy = false;
+	audioComp->bAllowSpatialization = true;
+	audioComp->bIsUISound = false;
+	audioComp->RegisterComponentWithWorld(GetWorld());
+	audioComp->OnAudioFinishedNative.AddUObject(this, &UAudioManagerSubsystem::OnAudioFinished);
+
+	PoolCategories.Add(ESoundCategory::World);
+	PoolInUse.Add(false);
+	return AudioPool.Add(audioComp);
+}
+
+void UAudioManagerSubsystem::OnAudioFinished(UAudioComponent* AudioComponent)
+{
+	const int32 poolIndex = AudioPool.IndexOfByKey(AudioComponent);
+	if (poolIndex == INDEX_NONE || !PoolInUse[poolIndex])
+		return;
+
+	PoolInUse[poolIndex] = false;
+	ActiveVoices[(uint8)PoolCategories[poolIndex]]--;
+}
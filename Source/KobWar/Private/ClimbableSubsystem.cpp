@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbableSubsystem.h"
+#include "ClimbingMesh.h"
+
+bool UClimbableSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* world = Cast<UWorld>(Outer);
+	return world && world->IsGameWorld();
+}
+
+void UClimbableSubsystem::RegisterClimbingMesh(AClimbingMesh* ClimbingMesh)
+{
+	if (!ClimbingMesh || ClimbingMeshes.Contains(ClimbingMesh))
+		return;
+
+	const int32 index = ClimbingMeshes.Add(ClimbingMesh);
+	ClimbBounds.Add(ClimbingMesh->GetComponentsBoundingBox());
+	ClimbAnchors.Add(ClimbingMesh->ClimbingMeshSceneComponent->GetComponentLocation());
+	AddToCells(index);
+}
+
+void UClimbableSubsystem::UnregisterClimbingMesh(AClimbingMesh* ClimbingMesh)
+{
+	const int32 index = ClimbingMeshes.IndexOfByKey(ClimbingMesh);
+	if (index == INDEX_NONE)
+		return;
+
+	RemoveFromCells(index);
+
+	const int32 lastIndex = ClimbingMeshes.Num() - 1;
+	if (index != lastIndex)
+	{
+		ReplaceInCells(lastIndex, index);
+	}
+
+	ClimbingMeshes.RemoveAtSwap(index, 1, false);
+	ClimbBounds.RemoveAtSwap(index, 1, false);
+	ClimbAnchors.RemoveAtSwap(index, 1, false);
+}
+
+AClimbingMesh* UClimbableSubsystem::FindClimbingMesh(const FBox& QueryBox) const
+{
+	const FIntPoint minCell = GetCell(QueryBox.Min);
+	const FIntPoint maxCell = GetCell(QueryBox.Max);
+	const FVector queryCenter = QueryBox.GetCenter();
+
+	// a mesh spanning several cells is tested once per cell, the distance check makes that harmless
+	int32 bestIndex = INDEX_NONE;
+	float bestDistSq = MAX_flt;
+
+	for (int32 x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+		{
+			const TArray<int32>* cell = Cells.Find(FIntPoint(x, y));
+			if (!cell)
+				continue;
+
+			for (const int32 index : *cell)
+			{
+				if (!ClimbBounds[index].Intersect(QueryBox))
+					continue;
+
+				// where meshes meet at a corner, climb the one whose anchor is nearest
+				const float distSq = FVector::DistSquared(ClimbAnchors[index], queryCenter);
+				if (distSq < bestDistSq)
+				{
+					bestIndex = index;
+					bestDistSq = distSq;
+				}
+			}
+		}
+	}
+
+	return bestIndex != INDEX_NONE ? ClimbingMeshes[bestIndex] : nullptr;
+}
+
+void UClimbableSubsystem::AddToCells(const int32 Index)
+{
+	const FIntPoint minCell = GetCell(ClimbBounds[Index].Min);
+	const FIntPoint maxCell = GetCell(ClimbBounds[Index].Max);
+
+	for (int32 x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+		{
+			Cells.FindOrAdd(FIntPoint(x, y)).Add(Index);
+		}
+	}
+}
+
+void UClimbableSubsystem::RemoveFromCells(const int32 Index)
+{
+	const FIntPoint minCell = GetCell(ClimbBounds[Index].Min);
+	const FIntPoint maxCell = GetCell(ClimbBounds[Index].Max);
+
+	for (int32 x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+		{
+			if (TArray<int32>* cell = Cells.Find(FIntPoint(x, y)))
+			{
+				cell->RemoveSingleSwap(Index, false);
+				if (cell->Num() == 0)
+				{
+					Cells.Remove(FIntPoint(x, y));
+				}
+			}
+		}
+	}
+}
+
+void UClimbableSubsystem::ReplaceInCells(const int32 OldIndex, const int32 NewIndex)
+{
+	const FIntPoint minCell = GetCell(ClimbBounds[OldIndex].Min);
+	const FIntPoint maxCell = GetCell(ClimbBounds[OldIndex].Max);
+
+	for (int32 x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+		{
+			if (TArray<int32>* cell = Cells.Find(FIntPoint(x, y)))
+			{
+				if (int32* entry = cell->FindByKey(OldIndex))
+				{
+					*entry = NewIndex;
+				}
+			}
+		}
+	}
+}
+
+FIntPoint UClimbableSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
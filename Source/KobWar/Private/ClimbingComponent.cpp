@@ -5,15 +5,33 @@
 #include "DrawDebugHelpers.h" 
 #include "LockOnComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "ClimbableSubsystem.h"
+#include "KobWarMovementComponent.h"
+#include "KobWarQuerySubsystem.h"
+#include "Navigation/NavLinkCustomComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 // Sets default values for this component's properties
 UClimbingComponent::UClimbingComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
+	// the climb itself is a movement mode of UKobWarMovementComponent, nothing to do per frame
+	PrimaryComponentTick.bCanEverTick = false;
 
-	// ...
+	SetIsReplicatedByDefault(true);
+}
+
+void UClimbingComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// the owner predicts its own climbs
+	FDoRepLifetimeParams sharedParams_SkipOwner;
+	sharedParams_SkipOwner.bIsPushBased = true;
+	sharedParams_SkipOwner.Condition = COND_SkipOwner;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(UClimbingComponent, ReplicatedClimb, sharedParams_SkipOwner);
 }
 
 
@@ -30,28 +48,18 @@ void UClimbingComponent::BeginPlay()
 		MoveDirBinding(true);
 
 	}
-
-	SetComponentTickEnabled(false);
-}
-
-void UClimbingComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
-{
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-	InterpToClimbingMesh(DeltaTime);
 }
 
 void UClimbingComponent::InitOwner()
 {
 	Owner = Cast<AKobWarCharacter>(GetOwner());
-	OwnerMovementComp = Owner->GetCharacterMovement();
+	OwnerMovementComp = Cast<UKobWarMovementComponent>(Owner->GetCharacterMovement());
 	ActionControlComp = Owner->GetActionControl();
 
-	if (OwnerMovementComp)
+	if (!OwnerMovementComp)
 	{
-		DefaultGravityScale = OwnerMovementComp->GravityScale;
+		UE_LOG(LogTemp, Warning, TEXT("UClimbingComponent: %s has no UKobWarMovementComponent, climbing is disabled"), *GetNameSafe(Owner));
 	}
-	
 }
 
 void UClimbingComponent::SpecialInputBinding(bool Bind)
@@ -99,7 +107,7 @@ void UClimbingComponent::SpecialInput(bool Pressed, bool Released)
 
 void UClimbingComponent::StartTraceTimer()
 {
-	GetWorld()->GetTimerManager().SetTimer(ClimbCheckTimer, this, &UClimbingComponent::TraceForClimb, 0.4f, true);
+	GetWorld()->GetTimerManager().SetTimer(ClimbCheckTimer, this, &UClimbingComponent::TraceForClimb, ClimbCheckInterval, true);
 }
 
 void UClimbingComponent::EndTraceTimer()
@@ -135,37 +143,19 @@ bool UClimbingComponent::TraceForClimbableMesh(AClimbingMesh*& FoundMesh)
 	FVector end = start + forwardVector * 50.0f;
 	FVector boxExtent(64.0f, 64.0f, 24.0f);
 
-	FCollisionQueryParams QueryParams;
-	TArray<FHitResult> hitResults;
-
-	bool bHit = GetWorld()->SweepMultiByChannel(
-		hitResults,
-		start,
-		end,
-		FQuat::Identity,
-		ECC_Visibility,  
-		FCollisionShape::MakeBox(boxExtent),
-		QueryParams
-	);
+	// box swept a step in front of the owner - only registered climb volumes are tested, not the whole scene
+	const FBox queryBox = FBox(start.ComponentMin(end) - boxExtent, start.ComponentMax(end) + boxExtent);
 
+#if ENABLE_DRAW_DEBUG && !UE_SERVER
 	if (DebugTrace)
 	{
-		DrawDebugBox(GetWorld(), start, boxExtent, FQuat::Identity, FColor::Green, false, 1.0f);
-
-	}
-
-	for (const FHitResult& HitResult : hitResults)
-	{
-		AActor* HitActor = HitResult.GetActor();
-		if (HitActor && HitActor->IsA(AClimbingMesh::StaticClass()))
-		{
-			FoundMesh = Cast<AClimbingMesh>(HitActor); // Found a climbing mesh
-			return true;
-		}
+		DrawDebugBox(GetWorld(), queryBox.GetCenter(), queryBox.GetExtent(), FQuat::Identity, FColor::Green, false, 1.0f);
 	}
+#endif
 
-	FoundMesh = nullptr;
-	return false;
+	auto* climbableSubsystem = GetWorld()->GetSubsystem<UClimbableSubsystem>();
+	FoundMesh = climbableSubsystem ? climbableSubsystem->FindClimbingMesh(queryBox) : nullptr;
+	return FoundMesh != nullptr;
 }
 
 void UClimbingComponent::MoveDirBinding(bool Bind)
@@ -224,21 +214,28 @@ bool UClimbingComponent::BeginClimbing(AClimbingMesh* ClimbableMesh)
 		CurrentClimbMesh = ClimbableMesh;
 		CurrentClimbState = ClimbState::BasicClimbing;
 		OnClimbStateChange.Broadcast(ClimbState::BasicClimbing);
-		OwnerMovementComp->GravityScale = 0.0f;
-		OwnerMovementComp->SetMovementMode(EMovementMode::MOVE_Flying);
-		OnMovementModeChangeEvent.Broadcast(EMovementMode::MOVE_Flying);
+		OwnerMovementComp->BeginClimb(ClimbableMesh->ClimbingMeshSceneComponent, ClimbableMesh);
+		OnMovementModeChangeEvent.Broadcast(EMovementMode::MOVE_Custom);
 		ActionEndBinding(true);
 		UpdateAnimationClimbingState(true);
 		UpdateOwnerClimbingState(true);
-		SetComponentTickEnabled(true);
-		Owner->GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		Owner->GetCapsuleComponent()->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
+		if (ActionControlComp)
+			ActionControlComp->SetClimbingMesh(ClimbableMesh);
 		Owner->UpdateState(ECharacterState::Ready);
 		ToggleLockOnLogic(false);
 
 		GetWorld()->GetTimerManager().SetTimer(AllowClimbInputTimer, this, &UClimbingComponent::EndClimbInputTimer, 0.4f);
 		WaitForInputTimerOnClimbStart = true;
 
+		if (Owner->HasAuthority())
+		{
+			SetReplicatedClimb(ClimbableMesh);
+		}
+		else if (Owner->IsLocallyControlled())
+		{
+			ServerBeginClimb(ClimbableMesh);
+		}
+
 		return true;
 	}
 
@@ -250,36 +247,6 @@ void UClimbingComponent::EndClimbInputTimer()
 	WaitForInputTimerOnClimbStart = false;
 }
 
-void UClimbingComponent::InterpToClimbingMesh(float DeltaTime)
-{
-	if (!CurrentClimbMesh || CurrentClimbState != ClimbState::BasicClimbing || !Owner)
-	{
-		return;
-	}
-
-	FVector currentActorLoc = Owner->GetActorLocation();
-	FVector2D currentActorLocXY = FVector2D(currentActorLoc.X, currentActorLoc.Y);
-
-	FVector targetActorLoc = CurrentClimbMesh->ClimbingMeshSceneComponent->GetComponentLocation();
-	FVector2D targetLocXY = FVector2D(targetActorLoc.X, targetActorLoc.Y);
-
-	FVector2D newLocXY = FMath::Vector2DInterpTo(currentActorLocXY, targetLocXY, DeltaTime, 5);
-
-	if (FVector2D::Distance(currentActorLocXY, targetLocXY) >= 5.0f)
-	{
-		Owner->SetActorLocation(FVector(newLocXY.X, newLocXY.Y, currentActorLoc.Z));
-	}
-
-	FRotator currentActorRot = Owner->GetActorRotation();
-	FRotator targetRot = CurrentClimbMesh->ClimbingMeshSceneComponent->GetComponentRotation();
-
-	FRotator newRot = FMath::RInterpTo(currentActorRot, targetRot, DeltaTime, 5);
-	newRot.Pitch = 0;
-	newRot.Roll = 0;
-
-	Owner->SetActorRotation(newRot);
-}
-
 void UClimbingComponent::ToggleLockOnLogic(bool Allow)
 {
 	if (Owner)
@@ -339,37 +306,213 @@ void UClimbingComponent::ActionEnd(FName EndedAction)
 
 void UClimbingComponent::ClimbEnd()
 {
+	FinishNavLinkClimb(CurrentClimbMesh);
 	ActionEndBinding(false);
 	CurrentClimbState = ClimbState::NotClimbing;
 	CurrentClimbMesh = nullptr;
-	OwnerMovementComp->GravityScale = DefaultGravityScale;
-	OwnerMovementComp->SetMovementMode(EMovementMode::MOVE_Walking);
+	OwnerMovementComp->EndClimb();
 	OnMovementModeChangeEvent.Broadcast(EMovementMode::MOVE_Walking);
 	//SnapOwnerToSurface();
 	OnClimbStateChange.Broadcast(ClimbState::NotClimbing);
 	UpdateAnimationClimbingState(false);
 	UpdateOwnerClimbingState(false);
-	SetComponentTickEnabled(false);
-	Owner->GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-	Owner->GetCapsuleComponent()->SetCollisionObjectType(ECollisionChannel::ECC_Pawn);
-	Owner->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	if (ActionControlComp)
+		ActionControlComp->SetClimbingMesh(nullptr);
 	Owner->UpdateState(ECharacterState::Ready);
 	ToggleLockOnLogic(true);
+
+	if (Owner->HasAuthority())
+	{
+		SetReplicatedClimb(nullptr);
+	}
+	else if (Owner->IsLocallyControlled())
+	{
+		ServerEndClimb();
+	}
+}
+
+void UClimbingComponent::ResetForPool()
+{
+	EndTraceTimer();
+	GetWorld()->GetTimerManager().ClearTimer(AllowClimbInputTimer);
+	WaitForInputTimerOnClimbStart = false;
+	ClimbHeld = false;
+
+	if (CurrentClimbState != ClimbState::NotClimbing && Owner && OwnerMovementComp)
+	{
+		ClimbEnd();
+	}
+}
+
+bool UClimbingComponent::BeginNavLinkClimb(AClimbingMesh* ClimbableMesh, UPathFollowingComponent* PathFollowing)
+{
+	if (!BeginClimbing(ClimbableMesh))
+		return false;
+
+	NavLinkPathFollowing = PathFollowing;
+	GetWorld()->GetTimerManager().SetTimer(NavLinkClimbTimer, this, &UClimbingComponent::NavLinkClimbStep, ClimbCheckInterval, true);
+	return true;
+}
+
+void UClimbingComponent::NavLinkClimbStep()
+{
+	// same as holding up - the climb to top action ends the climb, which finishes the link
+	if (CurrentClimbState == ClimbState::BasicClimbing && !WaitForInputTimerOnClimbStart && ActionControlComp)
+	{
+		ActionControlComp->ActivateOrQueueClimbUp(true, false);
+	}
+}
+
+void UClimbingComponent::FinishNavLinkClimb(AClimbingMesh* ClimbableMesh)
+{
+	GetWorld()->GetTimerManager().ClearTimer(NavLinkClimbTimer);
+
+	UPathFollowingComponent* pathFollowing = NavLinkPathFollowing.Get();
+	NavLinkPathFollowing.Reset();
+
+	if (pathFollowing && ClimbableMesh)
+	{
+		pathFollowing->FinishUsingCustomLink(ClimbableMesh->ClimbNavLink);
+	}
+}
+
+float UClimbingComponent::GetClimbProgress() const
+{
+	return ReplicatedClimb.Progress / 255.0f;
+}
+
+void UClimbingComponent::ServerBeginClimb_Implementation(AClimbingMesh* ClimbableMesh)
+{
+	if (CurrentClimbMesh == ClimbableMesh)
+		return;
+
+	if (!IsClimbValid(ClimbableMesh))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UClimbingComponent: rejected climb of %s by %s"), *GetNameSafe(ClimbableMesh), *GetNameSafe(Owner));
+		ClientRejectClimb();
+		return;
+	}
+
+	if (CurrentClimbState != ClimbState::NotClimbing)
+	{
+		ClimbEnd();
+	}
+
+	if (!BeginClimbing(ClimbableMesh))
+	{
+		ClientRejectClimb();
+	}
+}
+
+void UClimbingComponent::ServerEndClimb_Implementation()
+{
+	if (CurrentClimbState != ClimbState::NotClimbing)
+	{
+		ClimbEnd();
+	}
+}
+
+void UClimbingComponent::ClientRejectClimb_Implementation()
+{
+	if (CurrentClimbState != ClimbState::NotClimbing)
+	{
+		ClimbEnd();
+	}
+}
+
+bool UClimbingComponent::IsClimbValid(AClimbingMesh* ClimbableMesh) const
+{
+	auto* climbableSubsystem = GetWorld()->GetSubsystem<UClimbableSubsystem>();
+	if (!ClimbableMesh || !Owner || !climbableSubsystem || !climbableSubsystem->IsRegistered(ClimbableMesh))
+		return false;
+
+	const FVector ownerLoc = Owner->GetActorLocation();
+	const FVector anchorLoc = ClimbableMesh->ClimbingMeshSceneComponent->GetComponentLocation();
+	if (FVector::DistSquared2D(ownerLoc, anchorLoc) > FMath::Square(MaxClimbStartDistance))
+		return false;
+
+	// baked meshes also know their height range
+	if (ClimbableMesh->HasBakedClimbData)
+	{
+		return ownerLoc.Z >= ClimbableMesh->ClimbBottomZ - MaxClimbStartDistance && ownerLoc.Z <= ClimbableMesh->ClimbTopZ + MaxClimbStartDistance;
+	}
+
+	return true;
+}
+
+void UClimbingComponent::SetReplicatedClimb(AClimbingMesh* ClimbableMesh)
+{
+	ReplicatedClimb.ClimbMesh = ClimbableMesh;
+	ReplicatedClimb.Progress = 0;
+	MARK_PROPERTY_DIRTY_FROM_NAME(UClimbingComponent, ReplicatedClimb, this);
+
+	if (ClimbableMesh)
+	{
+		UpdateReplicatedProgress();
+		GetWorld()->GetTimerManager().SetTimer(ClimbProgressTimer, this, &UClimbingComponent::UpdateReplicatedProgress, ClimbProgressUpdateInterval, true);
+	}
+	else
+	{
+		GetWorld()->GetTimerManager().ClearTimer(ClimbProgressTimer);
+	}
+}
+
+void UClimbingComponent::UpdateReplicatedProgress()
+{
+	AClimbingMesh* climbMesh = ReplicatedClimb.ClimbMesh;
+	if (!climbMesh || !Owner)
+		return;
+
+	float bottomZ = climbMesh->ClimbBottomZ;
+	float topZ = climbMesh->ClimbTopZ;
+	if (!climbMesh->HasBakedClimbData)
+	{
+		const FBox bounds = climbMesh->GetComponentsBoundingBox();
+		bottomZ = bounds.Min.Z;
+		topZ = bounds.Max.Z;
+	}
+
+	const float alpha = FMath::Clamp((Owner->GetActorLocation().Z - bottomZ) / FMath::Max(topZ - bottomZ, 1.0f), 0.0f, 1.0f);
+	const uint8 progress = (uint8)FMath::RoundToInt(alpha * 255.0f);
+	if (progress != ReplicatedClimb.Progress)
+	{
+		ReplicatedClimb.Progress = progress;
+		MARK_PROPERTY_DIRTY_FROM_NAME(UClimbingComponent, ReplicatedClimb, this);
+	}
+}
+
+void UClimbingComponent::OnRep_ReplicatedClimb()
+{
+	// remote view of someone else's climb - state and animation only, their movement comes from the snapshots
+	if (ReplicatedClimb.ClimbMesh == CurrentClimbMesh)
+		return;
+
+	CurrentClimbMesh = ReplicatedClimb.ClimbMesh;
+	CurrentClimbState = CurrentClimbMesh ? ClimbState::BasicClimbing : ClimbState::NotClimbing;
+	OnClimbStateChange.Broadcast(CurrentClimbState);
+	UpdateAnimationClimbingState(CurrentClimbMesh != nullptr);
 }
 
 void UClimbingComponent::SnapOwnerToSurface()
 {
-	FVector start = Owner->GetActorLocation() + FVector(0,0,50);
-	FVector end = start - FVector(0, 0, 300);
+	auto* querySubsystem = GetWorld()->GetSubsystem<UKobWarQuerySubsystem>();
+	if (!querySubsystem)
+		return;
+
+	FKobWarQueryRequest query;
+	query.Start = Owner->GetActorLocation() + FVector(0,0,50);
+	query.End = query.Start - FVector(0, 0, 300);
+	query.IgnoreActor = Owner;
 
-	FHitResult HitResult;
-	FCollisionQueryParams Params;
-	Params.AddIgnoredActor(Owner);
+	querySubsystem->RequestTrace(query, FKobWarQueryDone::CreateUObject(this, &UClimbingComponent::OnSurfaceTraceDone));
+}
 
-	if (GetWorld()->LineTraceSingleByChannel(HitResult, start, end, ECC_Visibility, Params))
+void UClimbingComponent::OnSurfaceTraceDone(const FKobWarQueryResult& Result)
+{
+	// the climb may have started again while the trace was in flight
+	if (Result.IsHit && Owner && CurrentClimbState == ClimbState::NotClimbing)
 	{
-		FVector NewLocation = HitResult.Location;
-		Owner->SetActorLocation(NewLocation);
+		Owner->SetActorLocation(Result.Hit.Location);
 	}
 }
 
@@ -2,6 +2,13 @@
 
 
 #include "ClimbingMesh.h"
+#include "ClimbableSubsystem.h"
+#include "ClimbingComponent.h"
+#include "NavArea_Climb.h"
+#include "AIController.h"
+#include "Navigation/NavLinkCustomComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "NavAreas/NavArea_Null.h"
 
 AClimbingMesh::AClimbingMesh()
 {
@@ -9,4 +16,94 @@ AClimbingMesh::AClimbingMesh()
 
 	ClimbingMeshSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("ClimbingMeshSceneComponent"));
 	ClimbingMeshSceneComponent->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
+
+	// unusable until the exits have been baked
+	ClimbNavLink = CreateDefaultSubobject<UNavLinkCustomComponent>(TEXT("ClimbNavLink"));
+	ClimbNavLink->SetEnabledArea(UNavArea_Null::StaticClass());
+	ClimbNavLink->SetMoveReachedLink(this, &AClimbingMesh::OnClimbNavLinkReached);
+}
+
+void AClimbingMesh::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (auto* climbableSubsystem = GetWorld()->GetSubsystem<UClimbableSubsystem>())
+	{
+		climbableSubsystem->RegisterClimbingMesh(this);
+	}
+}
+
+void AClimbingMesh::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (auto* climbableSubsystem = GetWorld()->GetSubsystem<UClimbableSubsystem>())
+	{
+		climbableSubsystem->UnregisterClimbingMesh(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AClimbingMesh::BakeClimbData()
+{
+	UWorld* world = GetWorld();
+	if (!world)
+		return;
+
+	const FBox bounds = GetComponentsBoundingBox();
+	const FVector anchor = ClimbingMeshSceneComponent->GetComponentLocation();
+	const FVector forward = ClimbingMeshSceneComponent->GetForwardVector();
+
+	FHitResult hit;
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(ClimbBake), false);
+
+	// top exit - the ledge can be this mesh or whatever is behind it, so nothing is ignored
+	ClimbTopZ = bounds.Max.Z;
+	const FVector topProbe = FVector(anchor.X, anchor.Y, ClimbTopZ) + forward * TopExitDepth;
+	TopExit = world->LineTraceSingleByChannel(hit, topProbe + FVector(0.0f, 0.0f, ExitProbeHeight), topProbe - FVector(0.0f, 0.0f, ExitProbeHeight), ECC_Visibility, queryParams)
+		? hit.ImpactPoint : topProbe;
+
+	// bottom exit - floor behind the climber's back at the base
+	queryParams.AddIgnoredActor(this);
+	const FVector bottomProbe = FVector(anchor.X, anchor.Y, bounds.Min.Z) - forward * BottomExitDepth;
+	BottomExit = world->LineTraceSingleByChannel(hit, bottomProbe + FVector(0.0f, 0.0f, ExitProbeHeight), bottomProbe - FVector(0.0f, 0.0f, ExitProbeHeight), ECC_Visibility, queryParams)
+		? hit.ImpactPoint : bottomProbe;
+	ClimbBottomZ = FMath::Max(bounds.Min.Z, BottomExit.Z);
+
+	HasBakedClimbData = true;
+
+	// link points are relative to the actor and saved with the level, so the navmesh build picks them up
+	const FTransform& actorTransform = GetActorTransform();
+	ClimbNavLink->SetLinkData(actorTransform.InverseTransformPosition(BottomExit), actorTransform.InverseTransformPosition(TopExit), ENavLinkDirection::LeftToRight);
+	ClimbNavLink->SetEnabledArea(UNavArea_Climb::StaticClass());
+	ClimbNavLink->RefreshNavigationModifiers();
+}
+
+void AClimbingMesh::OnClimbNavLinkReached(UNavLinkCustomComponent* LinkComp, UObject* PathingAgent, const FVector& DestPoint)
+{
+	UPathFollowingComponent* pathFollowing = Cast<UPathFollowingComponent>(PathingAgent);
+	AAIController* controller = pathFollowing ? Cast<AAIController>(pathFollowing->GetOwner()) : nullptr;
+	APawn* pawn = controller ? controller->GetPawn() : nullptr;
+	UClimbingComponent* climbingComp = pawn ? pawn->FindComponentByClass<UClimbingComponent>() : nullptr;
+
+	if (climbingComp && climbingComp->BeginNavLinkClimb(this, pathFollowing))
+		return;
+
+	// the agent can't climb - stop here rather than wait on the link forever
+	if (pathFollowing)
+	{
+		pathFollowing->AbortMove(*this, FPathFollowingResultFlags::MovementStop);
+	}
+}
+
+#if WITH_EDITOR
+void AClimbingMesh::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	// covers both saving the level in the editor and cooking it - two traces per mesh, nothing scans the other meshes
+	if (GetWorld() && !GetWorld()->IsGameWorld())
+	{
+		BakeClimbData();
+	}
 }
+#endif
@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EffectsManagerSubsystem.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+
+bool UEffectsManagerSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* world = Cast<UWorld>(Outer);
+	return world && world->IsGameWorld() && !IsRunningDedicatedServer();
+}
+
+void UEffectsManagerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// spawning these mid fight is the hitch the pools exist to avoid
+	for (const FSoftObjectPath& templatePath : PrewarmTemplates)
+	{
+		UParticleSystem* particleTemplate = Cast<UParticleSystem>(templatePath.TryLoad());
+		if (!particleTemplate)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UEffectsManagerSubsystem: couldn't load prewarm template %s"), *templatePath.ToString());
+			continue;
+		}
+
+		FEffectPool& pool = Pools.FindOrAdd(particleTemplate);
+		for (int32 i = pool.FreeComponents.Num(); i < PrewarmCount; i++)
+		{
+			if (UParticleSystemComponent* effect = CreatePooledComponent(particleTemplate))
+			{
+				pool.FreeComponents.Add(effect);
+			}
+		}
+	}
+}
+
+void UEffectsManagerSubsystem::Deinitialize()
+{
+	for (auto& pool : Pools)
+	{
+		for (UParticleSystemComponent* effect : pool.Value.FreeComponents)
+		{
+			if (effect)
+			{
+				effect->DestroyComponent();
+			}
+		}
+	}
+
+	for (auto& active : ActiveEffects)
+	{
+		if (active.Key)
+		{
+			active.Key->OnSystemFinished.RemoveAll(this);
+			active.Key->DestroyComponent();
+		}
+	}
+
+	Pools.Empty();
+	ActiveEffects.Empty();
+
+	Super::Deinitialize();
+}
+
+FPooledEffectHandle UEffectsManagerSubsystem::SpawnPooledEffect(const UObject* WorldContextObject, UParticleSystem* Template, FVector Location, FRotator Rotation, EEffectCategory Category, float Scale)
+{
+	UWorld* world = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	auto* effectsManager = world ? world->GetSubsystem<UEffectsManagerSubsystem>() : nullptr;
+	return effectsManager ? effectsManager->SpawnEffect(Template, Location, Rotation, Category, Scale) : FPooledEffectHandle();
+}
+
+FPooledEffectHandle UEffectsManagerSubsystem::SpawnPooledEffectAttached(const UObject* WorldContextObject, UParticleSystem* Template, USceneComponent* AttachTo, FName SocketName, FVector Location, FRotator Rotation, EEffectCategory Category, float Scale)
+{
+	UWorld* world = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	auto* effectsManager = world ? world->GetSubsystem<UEffectsManagerSubsystem>() : nullptr;
+	return effectsManager ? effectsManager->SpawnEffectAttached(Template, AttachTo, SocketName, Location, Rotation, Category, Scale) : FPooledEffectHandle();
+}
+
+int32 UEffectsManagerSubsystem::GetSpawnBudget(EEffectCategory Category) const
+{
+	switch (Category)
+	{
+	case EEffectCategory::Stealth:
+		return MaxStealthEffects;
+	case EEffectCategory::Impact:
+		return MaxImpactEffects;
+	default:
+		return MaxEnvironmentEffects;
+	}
+}
+
+UParticleSystemComponent* UEffectsManagerSubsystem::AcquireEffect(UParticleSystem* Template, const FVector& Location, EEffectCategory Category)
+{
+	if (!Template || ActiveCounts[(uint8)Category] >= GetSpawnBudget(Category))
+		return nullptr;
+
+	APlayerController* playerController = GetWorld()->GetFirstPlayerController();
+	if (playerController && playerController->PlayerCameraManager
+		&& FVector::DistSquared(playerController->PlayerCameraManager->GetCameraLocation(), Location) > FMath::Square(MaxSpawnDistance))
+		return nullptr;
+
+	FEffectPool& pool = Pools.FindOrAdd(Template);
+	return pool.FreeComponents.Num() > 0 ? pool.FreeComponents.Pop(false) : CreatePooledComponent(Template);
+}
+
+FPooledEffectHandle UEffectsManagerSubsystem::ActivateEffect(UParticleSystemComponent* Effect, EEffectCategory Category, float Scale)
+{
+	Effect->SetWorldScale3D(FVector(Scale));
+	Effect->ActivateSystem(true);
+
+	FActiveEffect& activeEffect = ActiveEffects.Add(Effect);
+	activeEffect.Category = Category;
+	activeEffect.Generation = NextGeneration++;
+	ActiveCounts[(uint8)Category]++;
+
+	FPooledEffectHandle handle;
+	handle.Effect = Effect;
+	handle.Generation = activeEffect.Generation;
+	return handle;
+}
+
+FPooledEffectHandle UEffectsManagerSubsystem::SpawnEffect(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, EEffectCategory Category, float Scale)
+{
+	UParticleSystemComponent* effect = AcquireEffect(Template, Location, Category);
+	if (!effect)
+		return FPooledEffectHandle();
+
+	effect->SetWorldLocationAndRotation(Location, Rotation);
+	return ActivateEffect(effect, Category, Scale);
+}
+
+FPooledEffectHandle UEffectsManagerSubsystem::SpawnEffectAttached(UParticleSystem* Template, USceneComponent* AttachTo, FName SocketName, const FVector& Location, const FRotator& Rotation, EEffectCategory Category, float Scale)
+{
+	if (!AttachTo)
+		return FPooledEffectHandle();
+
+	UParticleSystemComponent* effect = AcquireEffect(Template, AttachTo->GetSocketLocation(SocketName), Category);
+	if (!effect)
+		return FPooledEffectHandle();
+
+	effect->AttachToComponent(AttachTo, FAttachmentTransformRules::KeepRelativeTransform, SocketName);
+	effect->SetRelativeLocationAndRotation(Location, Rotation);
+	return ActivateEffect(effect, Category, Scale);
+}
+
+void UEffectsManagerSubsystem::ReleaseEffect(const FPooledEffectHandle& Handle)
+{
+	// a handle from before the component went back to the pool mustn't stop whatever it plays now
+	const FActiveEffect* activeEffect = Handle.Effect ? ActiveEffects.Find(Handle.Effect) : nullptr;
+	if (!activeEffect || activeEffect->Generation != Handle.Generation)
+		return;
+
+	Handle.Effect->DeactivateImmediate();
+	OnEffectFinished(Handle.Effect);
+}
+
+UParticleSystemComponent* UEffectsManagerSubsystem::CreatePooledComponent(UParticleSystem* Template)
+{
+	AWorldSettings* worldSettings = GetWorld()->GetWorldSettings();
+	if (!worldSettings)
+		return nullptr;
+
+	UParticleSystemComponent* effect = NewObject<UParticleSystemComponent>(worldSettings);
+	effect->bAutoActivate = false;
+	effect->bAutoDestroy = false;
+	effect->SetTemplate(Template);
+	effect->RegisterComponentWithWorld(GetWorld());
+	effect->OnSystemFinished.AddDynamic(this, &UEffectsManagerSubsystem::OnEffectFinished);
+	return effect;
+}
+
+void UEffectsManagerSubsystem::OnEffectFinished(UParticleSystemComponent* Effect)
+{
+	FActiveEffect activeEffect;
+	if (!ActiveEffects.RemoveAndCopyValue(Effect, activeEffect))
+		return;
+
+	if (Effect->GetAttachParent())
+	{
+		Effect->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	}
+
+	ActiveCounts[(uint8)activeEffect.Category]--;
+	Pools.FindOrAdd(Effect->Template).FreeComponents.Add(Effect);
+}
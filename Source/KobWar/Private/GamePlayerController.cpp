@@ -2,6 +2,9 @@
 
 
 #include "GamePlayerController.h"
+#include "KobWar/KobWarCharacter.h"
+#include "LockOnComponent.h"
+#include "StealthPerceptionSubsystem.h"
 
 void AGamePlayerController::SetupInputComponent()
 {
@@ -29,6 +32,64 @@ void AGamePlayerController::SetupInputComponent()
 	InputComponent->BindAction("MenuMisc2", IE_Released, this, &AGamePlayerController::MenuMisc2Released).bConsumeInput = false;
 }
 
+bool AGamePlayerController::CanCreateWidgets() const
+{
+#if UE_SERVER
+	return false;
+#else
+	return IsLocalController() && !IsRunningDedicatedServer();
+#endif
+}
+
+void AGamePlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (HasAuthority())
+	{
+		ReleaseLockOnTarget();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AGamePlayerController::ServerSetLockOnTarget_Implementation(AActor* Target)
+{
+	if (Target == LockOnTargetActor.Get())
+		return;
+
+	// ignore targets the pawn couldn't plausibly be looking at
+	if (Target)
+	{
+		AKobWarCharacter* ownerCharacter = Cast<AKobWarCharacter>(GetPawn());
+		ULockOnComponent* lockOn = ownerCharacter ? ownerCharacter->FindComponentByClass<ULockOnComponent>() : nullptr;
+		AKobWarCharacter* targetCharacter = Cast<AKobWarCharacter>(Target);
+		if (!lockOn || !targetCharacter || !lockOn->IsLockOnTargetInView(targetCharacter->GetLockOnTargScene()))
+			return;
+
+		// nor stealthed targets the pawn hasn't noticed
+		auto* stealthPerception = GetWorld()->GetSubsystem<UStealthPerceptionSubsystem>();
+		if (stealthPerception && !stealthPerception->IsDetected(ownerCharacter, targetCharacter))
+			return;
+	}
+
+	ReleaseLockOnTarget();
+	LockOnTargetActor = Target;
+
+	if (auto* newTarget = Cast<AKobWarCharacter>(Target))
+	{
+		newTarget->AddLockOnWatcher(true);
+	}
+}
+
+void AGamePlayerController::ReleaseLockOnTarget()
+{
+	if (auto* oldTarget = Cast<AKobWarCharacter>(LockOnTargetActor.Get()))
+	{
+		oldTarget->AddLockOnWatcher(false);
+	}
+
+	LockOnTargetActor = nullptr;
+}
+
 void AGamePlayerController::MenuConfirmPressed()
 {
 	OnMenuConfirm.Broadcast(true, false);
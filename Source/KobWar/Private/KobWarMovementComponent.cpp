@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "KobWarMovementComponent.h"
+#include "GameFramework/Character.h"
+
+void UKobWarMovementComponent::BeginClimb(USceneComponent* ClimbAnchor, AActor* ClimbActor)
+{
+	CurrentClimbAnchor = ClimbAnchor;
+	CurrentClimbActor = ClimbActor;
+
+	if (ClimbAnchor)
+	{
+		SetMovementMode(MOVE_Custom, CMOVE_Climbing);
+	}
+}
+
+void UKobWarMovementComponent::EndClimb()
+{
+	if (IsClimbing())
+	{
+		SetMovementMode(MOVE_Walking);
+	}
+}
+
+float UKobWarMovementComponent::GetMaxSpeed() const
+{
+	if (IsClimbing())
+	{
+		return MaxClimbSpeed;
+	}
+
+	return Super::GetMaxSpeed();
+}
+
+void UKobWarMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	const bool wasClimbing = PreviousMovementMode == MOVE_Custom && PreviousCustomMode == CMOVE_Climbing;
+	if (wasClimbing == IsClimbing() || !UpdatedPrimitive)
+		return;
+
+	// the climber hugs the mesh - let the sweep pass through it rather than swapping collision profiles
+	if (CurrentClimbActor)
+	{
+		UpdatedPrimitive->IgnoreActorWhenMoving(CurrentClimbActor, IsClimbing());
+	}
+
+	if (IsClimbing())
+	{
+		Velocity = FVector::ZeroVector;
+	}
+	else
+	{
+		CurrentClimbAnchor = nullptr;
+		CurrentClimbActor = nullptr;
+	}
+}
+
+void UKobWarMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	if (CustomMovementMode == CMOVE_Climbing)
+	{
+		PhysClimbing(deltaTime, Iterations);
+		return;
+	}
+
+	Super::PhysCustom(deltaTime, Iterations);
+}
+
+void UKobWarMovementComponent::PhysicsRotation(float DeltaTime)
+{
+	// PhysClimbing turns the climber to face the anchor
+	if (IsClimbing())
+		return;
+
+	Super::PhysicsRotation(DeltaTime);
+}
+
+void UKobWarMovementComponent::PhysClimbing(float deltaTime, int32 Iterations)
+{
+	if (deltaTime < MIN_TICK_TIME)
+		return;
+
+	if (!CurrentClimbAnchor)
+	{
+		SetMovementMode(MOVE_Falling);
+		StartNewPhysics(deltaTime, Iterations);
+		return;
+	}
+
+	RestorePreAdditiveRootMotionVelocity();
+
+	const FVector oldLocation = UpdatedComponent->GetComponentLocation();
+	const FVector anchorLocation = CurrentClimbAnchor->GetComponentLocation();
+
+	// climbing up and down is root motion from the climb actions - on its own the climber only holds onto the anchor
+	if (!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+	{
+		const FVector2D currentXY = FVector2D(oldLocation);
+		const FVector2D anchorXY = FVector2D(anchorLocation);
+		FVector2D snapXY = currentXY;
+		if (FVector2D::Distance(currentXY, anchorXY) >= ClimbSnapTolerance)
+		{
+			snapXY = FMath::Vector2DInterpTo(currentXY, anchorXY, deltaTime, ClimbSnapSpeed);
+		}
+
+		Velocity = FVector((snapXY - currentXY) / deltaTime, 0.0f);
+	}
+
+	ApplyRootMotionToVelocity(deltaTime);
+
+	Iterations++;
+	bJustTeleported = false;
+
+	FRotator newRotation = FMath::RInterpTo(UpdatedComponent->GetComponentRotation(), CurrentClimbAnchor->GetComponentRotation(), deltaTime, ClimbRotationSpeed);
+	newRotation.Pitch = 0.0f;
+	newRotation.Roll = 0.0f;
+
+	const FVector delta = Velocity * deltaTime;
+	FHitResult hit(1.0f);
+	SafeMoveUpdatedComponent(delta, newRotation.Quaternion(), true, hit);
+
+	if (hit.Time < 1.0f)
+	{
+		HandleImpact(hit, deltaTime, delta);
+		SlideAlongSurface(delta, 1.0f - hit.Time, hit.Normal, hit, true);
+	}
+
+	if (!bJustTeleported && !HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+	{
+		Velocity = (UpdatedComponent->GetComponentLocation() - oldLocation) / deltaTime;
+	}
+}
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "KobWarQuerySubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Submit batch"), STAT_KobWarQuerySubmit, STATGROUP_KobWarQuery);
+DECLARE_CYCLE_STAT(TEXT("Dispatch results"), STAT_KobWarQueryDispatch, STATGROUP_KobWarQuery);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queries submitted"), STAT_KobWarQueriesSubmitted, STATGROUP_KobWarQuery);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queries deferred"), STAT_KobWarQueriesDeferred, STATGROUP_KobWarQuery);
+
+bool UKobWarQuerySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* world = Cast<UWorld>(Outer);
+	return world && world->IsGameWorld();
+}
+
+void UKobWarQuerySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(KobWarQuery), false);
+	TraceDelegate.BindUObject(this, &UKobWarQuerySubsystem::OnQueryCompleted);
+}
+
+void UKobWarQuerySubsystem::Deinitialize()
+{
+	PendingQueries.Empty();
+	InFlightQueries.Empty();
+	LatestResults.Empty();
+	TraceDelegate.Unbind();
+
+	Super::Deinitialize();
+}
+
+bool UKobWarQuerySubsystem::IsTickable() const
+{
+	return PendingQueries.Num() > 0 && GetWorld();
+}
+
+TStatId UKobWarQuerySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UKobWarQuerySubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UKobWarQuerySubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+void UKobWarQuerySubsystem::RequestTrace(const FKobWarQueryRequest& Request, FKobWarQueryDone Callback)
+{
+	FPendingQuery& query = PendingQueries.AddDefaulted_GetRef();
+	query.Request = Request;
+	query.Callback = MoveTemp(Callback);
+}
+
+bool UKobWarQuerySubsystem::TraceLatest(const AActor* Owner, FName Tag, const FKobWarQueryRequest& Request, FKobWarQueryResult& OutResult)
+{
+	const FKobWarQueryKey key(Owner, Tag);
+
+	if (FPendingQuery* pending = PendingQueries.FindByPredicate([&key](const FPendingQuery& Query) { return Query.Key == key; }))
+	{
+		pending->Request = Request;
+	}
+	else
+	{
+		FPendingQuery& query = PendingQueries.AddDefaulted_GetRef();
+		query.Request = Request;
+		query.Key = key;
+	}
+
+	const FKobWarQueryResult* latest = LatestResults.Find(key);
+	if (!latest)
+		return false;
+
+	OutResult = *latest;
+	return true;
+}
+
+void UKobWarQuerySubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_KobWarQuerySubmit);
+
+	PruneLatestResults();
+
+	const int32 submitCount = FMath::Min(PendingQueries.Num(), MaxQueriesPerFrame);
+
+	for (int32 i = 0; i < submitCount; i++)
+	{
+		const uint32 queryId = NextQueryId++;
+		Submit(PendingQueries[i].Request, queryId);
+		InFlightQueries.Add(queryId, MoveTemp(PendingQueries[i]));
+	}
+
+	// oldest first, whatever is over budget waits for the next frame
+	PendingQueries.RemoveAt(0, submitCount, false);
+
+	QueriesSubmitted += submitCount;
+	SET_DWORD_STAT(STAT_KobWarQueriesSubmitted, submitCount);
+	SET_DWORD_STAT(STAT_KobWarQueriesDeferred, PendingQueries.Num());
+}
+
+void UKobWarQuerySubsystem::Submit(const FKobWarQueryRequest& Request, uint32 QueryId)
+{
+	QueryParams.ClearIgnoredActors();
+	QueryParams.AddIgnoredActor(Request.IgnoreActor.Get());
+	QueryParams.AddIgnoredActor(Request.IgnoreActor2.Get());
+
+	if (Request.Shape.IsLine())
+	{
+		GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Request.Start, Request.End, Request.Channel, QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, QueryId);
+	}
+	else
+	{
+		GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Single, Request.Start, Request.End, Request.Rotation, Request.Channel, Request.Shape, QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, QueryId);
+	}
+}
+
+void UKobWarQuerySubsystem::OnQueryCompleted(const FTraceHandle& Handle, FTraceDatum& Data)
+{
+	SCOPE_CYCLE_COUNTER(STAT_KobWarQueryDispatch);
+
+	FPendingQuery query;
+	if (!InFlightQueries.RemoveAndCopyValue(Data.UserData, query))
+		return;
+
+	FKobWarQueryResult result;
+	result.Start = query.Request.Start;
+	result.Frame = GFrameCounter;
+	if (Data.OutHits.Num() > 0 && Data.OutHits[0].bBlockingHit)
+	{
+		result.Hit = Data.OutHits[0];
+		result.IsHit = true;
+	}
+
+	if (query.Key.Key.IsValid())
+	{
+		LatestResults.Add(query.Key, result);
+	}
+
+	query.Callback.ExecuteIfBound(result);
+}
+
+void UKobWarQuerySubsystem::PruneLatestResults()
+{
+	for (auto it = LatestResults.CreateIterator(); it; ++it)
+	{
+		if (!it.Key().Key.IsValid())
+		{
+			it.RemoveCurrent();
+		}
+	}
+}
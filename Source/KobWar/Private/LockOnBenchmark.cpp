@@ -0,0 +1,239 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LockOnBenchmarkComponent.h"
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Engine/Engine.h"
+#include "GameFramework/WorldSettings.h"
+#include "Kismet/GameplayStatics.h"
+#include "KobWar/KobWarCharacter.h"
+#include "VisibilitySubsystem.h"
+
+bool ULockOnBenchmarkComponent::InitView(AKobWarCharacter* Viewer)
+{
+	UCameraComponent* camera = Viewer ? Viewer->GetFollowCamera() : nullptr;
+	if (!camera)
+		return false;
+
+	OwnerCharacter = Viewer;
+	OwnerCamComponent = camera;
+	DefaultCamRotationRelative = camera->GetRelativeRotation();
+
+	FMinimalViewInfo viewInfo;
+	camera->GetCameraView(0.0f, viewInfo);
+	FMatrix viewMatrix;
+	FMatrix projectionMatrix;
+	UGameplayStatics::GetViewProjectionMatrix(viewInfo, viewMatrix, projectionMatrix, ViewProjection);
+	ViewRect = FIntRect(0, 0, 1920, 1080);
+	return true;
+}
+
+bool ULockOnBenchmarkComponent::GetViewProjection(FMatrix& OutViewProjection, FIntRect& OutViewRect) const
+{
+	OutViewProjection = ViewProjection;
+	OutViewRect = ViewRect;
+	return true;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS && !UE_SERVER
+
+// Timings are only reported. The test fails on growth no machine noise explains - an operation at 128 targets costing
+// more than MaxScalingOverLinear times what linear scaling from 8 targets would give, or memory kept per operation.
+static const int32 LockOnBenchIterations = 200;
+static const double MaxScalingOverLinear = 2.0;
+static const double MaxRetainedBytesPerOp = 1024.0;
+
+/* Bytes LLM is tracking right now, or -1 when the run wasn't started with -llm */
+static int64 GetTrackedMemory()
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	if (FLowLevelMemTracker::IsEnabled())
+	{
+		return (int64)FLowLevelMemTracker::Get().GetTotalTrackedMemory(ELLMTracker::Default);
+	}
+#endif
+	return -1;
+}
+
+/**
+ * Lock-on stress numbers with 8, 32 and 128 targets around a viewer in a throwaway game world. Times lock on / unlock
+ * presses, rapid target switches and verification requests, and counts the visibility traces and the memory each one
+ * keeps. The numbers are the client side pick only - the viewer has no player controller to send RPCs through.
+ */
+struct FLockOnBenchmark
+{
+	struct FResult
+	{
+		double PressMicroseconds = 0.0;
+		double SwitchMicroseconds = 0.0;
+		double VerifyMicroseconds = 0.0;
+		uint32 PressTraces = 0;
+		uint32 SwitchTraces = 0;
+		double PressBytes = -1.0;
+		double SwitchBytes = -1.0;
+		double VerifyBytes = -1.0;
+	};
+
+	static void SpawnDummies(UWorld* World, ULockOnBenchmarkComponent* LockOn, const int32 Count, TArray<AKobWarCharacter*>& OutDummies)
+	{
+		const UCameraComponent* camera = LockOn->GetCamera();
+		FActorSpawnParameters spawnParams;
+		spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		const FVector viewPos = camera->GetComponentLocation();
+		const FRotator viewRot = camera->GetComponentRotation();
+
+		// rings inside the camera's fov, 500 to 2000 units out
+		for (int32 i = 0; i < Count; i++)
+		{
+			const float yaw = FMath::Lerp(-30.0f, 30.0f, (i % 8) / 7.0f);
+			const float distance = 500.0f + 1500.0f * (i / 8) / FMath::Max(1, (Count - 1) / 8);
+			const FVector location = viewPos + FRotator(0.0f, viewRot.Yaw + yaw, 0.0f).Vector() * distance;
+
+			if (AKobWarCharacter* dummy = World->SpawnActor<AKobWarCharacter>(AKobWarCharacter::StaticClass(), location, FRotator::ZeroRotator, spawnParams))
+			{
+				OutDummies.Add(dummy);
+			}
+		}
+	}
+
+	/* Per operation bytes still allocated since MemoryBefore, -1 without LLM */
+	static double GetRetainedBytes(const int64 MemoryBefore, const int32 Operations)
+	{
+		const int64 memoryAfter = GetTrackedMemory();
+		return MemoryBefore >= 0 && memoryAfter >= 0 ? (double)(memoryAfter - MemoryBefore) / Operations : -1.0;
+	}
+
+	static FResult Run(ULockOnBenchmarkComponent* LockOn, UVisibilitySubsystem* VisibilitySubsystem, const int32 Iterations)
+	{
+		FResult result;
+		static const FVector2D switchDirs[] = { FVector2D(1.0f, 0.0f), FVector2D(-1.0f, 0.0f), FVector2D(0.0f, 1.0f), FVector2D(0.0f, -1.0f) };
+
+		LockOn->Unlock();
+		VisibilitySubsystem->ClearCache();
+
+		// one untimed round so the scratch arrays, cache and timers have grown to size
+		LockOn->Press();
+		LockOn->Switch(switchDirs[0]);
+		LockOn->Verify();
+		LockOn->Press();
+		VisibilitySubsystem->ClearCache();
+
+		// lock on and off
+		uint32 tracesBefore = VisibilitySubsystem->GetTracesIssued();
+		int64 memoryBefore = GetTrackedMemory();
+		double startTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; i++)
+		{
+			LockOn->Press();
+			LockOn->Press();
+		}
+		result.PressMicroseconds = (FPlatformTime::Seconds() - startTime) * 1000000.0 / (Iterations * 2);
+		result.PressBytes = GetRetainedBytes(memoryBefore, Iterations * 2);
+		result.PressTraces = VisibilitySubsystem->GetTracesIssued() - tracesBefore;
+
+		// flick between targets
+		LockOn->Press();
+		tracesBefore = VisibilitySubsystem->GetTracesIssued();
+		memoryBefore = GetTrackedMemory();
+		startTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; i++)
+		{
+			LockOn->Switch(switchDirs[i % 4]);
+		}
+		result.SwitchMicroseconds = (FPlatformTime::Seconds() - startTime) * 1000000.0 / Iterations;
+		result.SwitchBytes = GetRetainedBytes(memoryBefore, Iterations);
+		result.SwitchTraces = VisibilitySubsystem->GetTracesIssued() - tracesBefore;
+
+		// verification requests, answered from the cache
+		memoryBefore = GetTrackedMemory();
+		startTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; i++)
+		{
+			LockOn->Verify();
+		}
+		result.VerifyMicroseconds = (FPlatformTime::Seconds() - startTime) * 1000000.0 / Iterations;
+		result.VerifyBytes = GetRetainedBytes(memoryBefore, Iterations);
+
+		LockOn->Unlock();
+
+		return result;
+	}
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLockOnStressTest, "KobWar.LockOn.Stress", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FLockOnStressTest::RunTest(const FString& Parameters)
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(world);
+
+	world->InitializeActorsForPlay(FURL());
+	world->GetWorldSettings()->NotifyBeginPlay();
+
+	AKobWarCharacter* viewer = world->SpawnActor<AKobWarCharacter>(AKobWarCharacter::StaticClass(), FVector::ZeroVector, FRotator::ZeroRotator);
+	ULockOnBenchmarkComponent* lockOn = viewer ? NewObject<ULockOnBenchmarkComponent>(viewer) : nullptr;
+	if (lockOn)
+	{
+		lockOn->RegisterComponent();
+	}
+	UVisibilitySubsystem* visibilitySubsystem = world->GetSubsystem<UVisibilitySubsystem>();
+
+	if (TestTrue(TEXT("Viewer has a follow camera"), lockOn && lockOn->InitView(viewer)) && TestNotNull(TEXT("Visibility subsystem"), visibilitySubsystem))
+	{
+		if (GetTrackedMemory() < 0)
+		{
+			AddInfo(TEXT("Run with -llm to measure the memory each operation keeps"));
+		}
+
+		static const int32 dummyCounts[] = { 8, 32, 128 };
+		TArray<FLockOnBenchmark::FResult> results;
+		for (const int32 dummyCount : dummyCounts)
+		{
+			TArray<AKobWarCharacter*> dummies;
+			FLockOnBenchmark::SpawnDummies(world, lockOn, dummyCount, dummies);
+
+			const FLockOnBenchmark::FResult& result = results.Add_GetRef(FLockOnBenchmark::Run(lockOn, visibilitySubsystem, LockOnBenchIterations));
+
+			AddInfo(FString::Printf(TEXT("%3d targets | press %.2f us, %u traces, %.0f bytes | switch %.2f us, %u traces, %.0f bytes | verify %.2f us, %.0f bytes"),
+				dummyCount,
+				result.PressMicroseconds, result.PressTraces, result.PressBytes,
+				result.SwitchMicroseconds, result.SwitchTraces, result.SwitchBytes,
+				result.VerifyMicroseconds, result.VerifyBytes));
+
+			// the visibility cache answers every repeat, so traces can't scale with the iteration count
+			TestTrue(FString::Printf(TEXT("%d targets: press traces within one per target"), dummyCount), result.PressTraces <= (uint32)dummyCount);
+			TestTrue(FString::Printf(TEXT("%d targets: switch traces within one per target"), dummyCount), result.SwitchTraces <= (uint32)dummyCount);
+
+			TestTrue(FString::Printf(TEXT("%d targets: press keeps no memory"), dummyCount), result.PressBytes <= MaxRetainedBytesPerOp);
+			TestTrue(FString::Printf(TEXT("%d targets: switch keeps no memory"), dummyCount), result.SwitchBytes <= MaxRetainedBytesPerOp);
+			TestTrue(FString::Printf(TEXT("%d targets: verify keeps no memory"), dummyCount), result.VerifyBytes <= MaxRetainedBytesPerOp);
+
+			for (AKobWarCharacter* dummy : dummies)
+			{
+				dummy->Destroy();
+			}
+		}
+
+		// sub-microsecond baselines are timer noise, growth is measured from at least 1 us
+		const double targetRatio = (double)dummyCounts[UE_ARRAY_COUNT(dummyCounts) - 1] / dummyCounts[0];
+		auto testScaling = [this, targetRatio](const TCHAR* Operation, const double Smallest, const double Largest)
+		{
+			const double growth = Largest / FMath::Max(Smallest, 1.0);
+			TestTrue(FString::Printf(TEXT("%s grows %.1fx for %.0fx the targets"), Operation, growth, targetRatio), growth <= targetRatio * MaxScalingOverLinear);
+		};
+
+		testScaling(TEXT("Press"), results[0].PressMicroseconds, results.Last().PressMicroseconds);
+		testScaling(TEXT("Switch"), results[0].SwitchMicroseconds, results.Last().SwitchMicroseconds);
+		testScaling(TEXT("Verify"), results[0].VerifyMicroseconds, results.Last().VerifyMicroseconds);
+	}
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+
+	return true;
+}
+
+#endif
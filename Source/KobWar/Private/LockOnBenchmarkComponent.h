@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LockOnComponent.h"
+#include "LockOnBenchmarkComponent.generated.h"
+
+/**
+ * Only for the KobWar.LockOn.Stress automation test. Sees through a fixed 1920x1080 screen view of the owner's follow
+ * camera instead of a viewport, and has no player controller, so SetLockOnTarget never sends ServerSetLockOnTarget.
+ */
+UCLASS(NotBlueprintable, HideDropdown)
+class ULockOnBenchmarkComponent : public ULockOnComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	bool InitView(AKobWarCharacter* Viewer);
+
+	void Press() { LockOnPress(true, false); }
+
+	void Switch(const FVector2D& InputDir)
+	{
+		IsLockSwitchTimerActive = false;
+		LockOnMoveDir(InputDir, 1.0f);
+	}
+
+	void Verify() { LockOnVerify(); }
+
+	void Unlock()
+	{
+		SetLockOnTarget(nullptr);
+		EndLockSwitchTimer();
+	}
+
+	UCameraComponent* GetCamera() const { return OwnerCamComponent; }
+
+protected:
+
+	virtual bool HasScreenView() const override { return true; }
+
+	virtual bool GetViewProjection(FMatrix& OutViewProjection, FIntRect& OutViewRect) const override;
+
+	FMatrix ViewProjection = FMatrix::Identity;
+
+	FIntRect ViewRect;
+
+};
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LockOnCameraModifier.h"
+#include "KobWar/KobWarCharacter.h"
+#include "LockOnTargSceneComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/SpringArmComponent.h"
+
+ULockOnCameraModifier::ULockOnCameraModifier()
+{
+	bDisabled = true;
+}
+
+void ULockOnCameraModifier::SetLockOnTarget(ULockOnTargSceneComponent* Target)
+{
+	LockOnTarget = Target;
+
+	if (Target)
+	{
+		EnableModifier();
+	}
+	else
+	{
+		DisableModifier(true);
+	}
+}
+
+bool ULockOnCameraModifier::ModifyCamera(float DeltaTime, FMinimalViewInfo& InOutPOV)
+{
+	Super::ModifyCamera(DeltaTime, InOutPOV);
+
+	ULockOnTargSceneComponent* target = LockOnTarget.Get();
+	APlayerController* controller = CameraOwner ? CameraOwner->GetOwningPlayerController() : nullptr;
+	AKobWarCharacter* ownerCharacter = controller ? Cast<AKobWarCharacter>(controller->GetPawn()) : nullptr;
+	if (!target || !ownerCharacter || !ownerCharacter->GetCameraBoom())
+		return false;
+
+	const FVector armOrigin = ownerCharacter->GetCameraBoom()->GetComponentLocation();
+
+	FVector targetPos = target->GetComponentLocation() + TargetOffset;
+	if (AActor* targetOwner = target->GetOwner())
+	{
+		targetPos += targetOwner->GetVelocity() * VelocityPredictionTime;
+	}
+
+	const FRotator lookAtRot = (targetPos - (armOrigin + PivotOffset)).Rotation();
+	const FRotator controlRot = controller->GetControlRotation();
+	const FRotator newRot = FMath::RInterpTo(controlRot, lookAtRot, DeltaTime, LockOnRotSpeed);
+	controller->SetControlRotation(newRot);
+
+	// the arm already placed this frame's view from the old control rotation - swing it around the arm by the difference
+	const FQuat deltaQuat = newRot.Quaternion() * controlRot.Quaternion().Inverse();
+	InOutPOV.Location = armOrigin + deltaQuat.RotateVector(InOutPOV.Location - armOrigin);
+	InOutPOV.Rotation = (deltaQuat * InOutPOV.Rotation.Quaternion()).Rotator();
+
+	return false;
+}
@@ -4,16 +4,19 @@
 #include "LockOnComponent.h"
 #include "KobWar/KobWarCharacter.h"
 #include "GamePlayerController.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "SceneView.h"
+#include "VisibilitySubsystem.h"
+#include "DrawDebugHelpers.h"
+#include "LockOnCameraModifier.h"
+#include "StealthPerceptionSubsystem.h"
 
 // Sets default values for this component's properties
 ULockOnComponent::ULockOnComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
-	SetComponentTickEnabled(false);
-
-	// ...
+	// facing the target is done by ULockOnCameraModifier, nothing to do per frame
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 
@@ -44,10 +47,12 @@ void ULockOnComponent::InitOwnerLink()
 			DefaultCamRotationRelative = OwnerCamComponent->GetRelativeRotation();
 			OwnerSpringArmComponent = OwnerCharacter->GetCameraBoom();
 
-			OwnerCharacter->OnLookDir.AddDynamic(this, &ULockOnComponent::LockOnMoveDir);
-			OwnerCharacter->OnLockOnButton.AddDynamic(this, &ULockOnComponent::LockOnPress);
+			// unique - pooled characters are possessed again without being reconstructed
+			OwnerCharacter->OnLookDir.AddUniqueDynamic(this, &ULockOnComponent::LockOnMoveDir);
+			OwnerCharacter->OnLockOnButton.AddUniqueDynamic(this, &ULockOnComponent::LockOnPress);
 		
 			OwnerPlayerController = Cast<AGamePlayerController>(OwnerCharacter->GetController());
+			InitCameraModifier();
 		}
 	}
 }
@@ -85,26 +90,24 @@ ULockOnTargSceneComponent* ULockOnComponent::LockOnFindTarget()
 	// find only the best target:
 	// ideal target is closest to the center of the screen
 
-	auto availableTargets = GetPotentialCharactersForLockOn();
+	if (!HasScreenView())
+	{
+		// no screen to project to - pick in view space instead
+		auto* targetSubsystem = GetWorld()->GetSubsystem<ULockOnTargetSubsystem>();
+		return targetSubsystem ? targetSubsystem->FindBestTarget(MakeViewQuery()) : nullptr;
+	}
+
+	GetPotentialCharactersForLockOn(CandidateScratch);
 
 	float bestAngle = 400.0f;
 	AKobWarCharacter* bestChar = nullptr;
 
-	TArray<AKobWarCharacter*> keys;
-	availableTargets.GetKeys(keys);
-
-	if (keys.Num() <= 0)
-	{
-		return nullptr;
-	}
-
-	for (auto* character : keys)
+	for (const FLockOnCandidate& candidate : CandidateScratch)
 	{
-		FVector2D val = *availableTargets.Find(character);
-		if (val.X < bestAngle)
+		if (candidate.AngleDistance < bestAngle)
 		{
-			bestChar = character;
-			bestAngle = val.X;
+			bestChar = candidate.Character;
+			bestAngle = candidate.AngleDistance;
 		}
 	}
 
@@ -116,11 +119,20 @@ ULockOnTargSceneComponent* ULockOnComponent::LockOnFindTarget()
 
 bool ULockOnComponent::SetLockOnTarget(ULockOnTargSceneComponent* LockOnTarg)
 {
+	if (OwnerPlayerController && LockOnTarg != LockOnTarget)
+	{
+		OwnerPlayerController->ServerSetLockOnTarget(LockOnTarg ? LockOnTarg->GetOwner() : nullptr);
+	}
+
 	if (LockOnTarg)
 	{
 		StartLockSwitchTimer();
 		LockOnTarget = LockOnTarg;
-		SetComponentTickEnabled(true);
+		if (LockOnCameraModifier)
+		{
+			LockOnCameraModifier->LockOnRotSpeed = LockOnRotSpeed;
+			LockOnCameraModifier->SetLockOnTarget(LockOnTarg);
+		}
 		OnLockedOn.Broadcast(true, LockOnTarg);
 		UpdateOwnerLockOnState(true);
 		StartLockOnVerifyTimer();
@@ -128,7 +140,10 @@ bool ULockOnComponent::SetLockOnTarget(ULockOnTargSceneComponent* LockOnTarg)
 	}
 
 
-	SetComponentTickEnabled(false);
+	if (LockOnCameraModifier)
+	{
+		LockOnCameraModifier->SetLockOnTarget(nullptr);
+	}
 	LockOnTarget = nullptr;
 	OnLockedOn.Broadcast(false, nullptr);
 	UpdateOwnerLockOnState(false);
@@ -155,54 +170,36 @@ void ULockOnComponent::LockOnMoveDir(FVector2D InputDir, float Value)
 		return;
 	}
 
-	float inputAngleRadians = FMath::Atan2(-InputDir.Y, InputDir.X) + PI/2;
-	float inputAngleDegrees = FMath::RadiansToDegrees(inputAngleRadians);
-	if (inputAngleDegrees < 0.0f)
+	// stick direction in screen space - screen Y points down
+	const FVector2D inputDir = FVector2D(InputDir.X, -InputDir.Y).GetSafeNormal();
+	if (inputDir.IsZero())
 	{
-		inputAngleDegrees += 360.0f;
+		return;
 	}
 
-	auto availableTargets = GetPotentialCharactersForLockOn();
+	GetPotentialCharactersForLockOn(CandidateScratch);
 
-	float bestAngle = 2000.0f;
+	// cos(70) and cos(30) - candidates within 70 degrees of the stick, within 30 counts as aligned
+	static const float cosMaxAngle = 0.342020f;
+	static const float cosAlignedAngle = 0.866025f;
+
+	float bestCos = -1.0f;
 	float bestDist = 8000.0f;
 	AKobWarCharacter* bestChar = nullptr;
 
-	TArray<AKobWarCharacter*> keys;
-	availableTargets.GetKeys(keys);
-
-	if (keys.Num() <= 0)
+	for (const FLockOnCandidate& candidate : CandidateScratch)
 	{
-		return;
-	}
-
-	for (auto* character : keys)
-	{
-		if (character->GetLockOnTargScene() == LockOnTarget)
+		if (candidate.Target == LockOnTarget)
 		{
 			continue;
 		}
 
-		FVector2D val = *availableTargets.Find(character);
-		float angleDif = inputAngleDegrees - val.Y;
-		float posDist = val.X;
-
-		UE_LOG(LogTemp, Warning, TEXT("Char Angle Dist %f   | Char Angle Dir %f    | InputAngle %f   | AngleDif %f"), val.X, val.Y, inputAngleDegrees, angleDif);
-
-
-		if (angleDif > 180.0f)
-		{
-			angleDif -= 360.0f;  // Adjust for wrapping around
-		}
-		else if (angleDif < -180.0f)
+		const float cosDif = FVector2D::DotProduct(candidate.ScreenDirection, inputDir);
+		if (cosDif >= cosMaxAngle && ((cosDif >= cosAlignedAngle && cosDif > bestCos) || candidate.AngleDistance < bestDist))
 		{
-			angleDif += 360.0f;  // Adjust for wrapping around
-		}
-		if (FMath::Abs(angleDif) <= 70.0f && (((FMath::Abs(angleDif) <= 30.0f ) && angleDif < bestAngle) || (posDist < bestDist)))
-		{
-			bestChar = character;
-			bestAngle = angleDif;
-			bestDist = posDist;
+			bestChar = candidate.Character;
+			bestCos = cosDif;
+			bestDist = candidate.AngleDistance;
 		}
 	}
 
@@ -224,68 +221,94 @@ void ULockOnComponent::EndLockSwitchTimer()
 	IsLockSwitchTimerActive = false;
 }
 
-bool ULockOnComponent::IsPosInFov(const FVector ViewPosition, const FRotator ViewRot, const bool IsCurrentlyLockedOn, const FVector CurrentLockOnPos, const FVector TargPosition, const float Fov, float& AngleDistance, float& AngleDirection)
+bool ULockOnComponent::GetViewProjection(FMatrix& ViewProjection, FIntRect& ViewRect) const
 {
-	// angle distance
-	FVector directionToTarg = (TargPosition - ViewPosition).GetSafeNormal();
-	float dotProduct = FVector::DotProduct(ViewRot.Vector(), directionToTarg);
-	float angleFovRadians = FMath::Acos(dotProduct);
+	// ai units shouldnt be using this function
+	ULocalPlayer* localPlayer = OwnerPlayerController ? OwnerPlayerController->GetLocalPlayer() : nullptr;
+	if (!localPlayer || !localPlayer->ViewportClient)
+		return false;
+
+	FSceneViewProjectionData projectionData;
+	if (!localPlayer->GetProjectionData(localPlayer->ViewportClient->Viewport, eSSP_FULL, projectionData))
+		return false;
+
+	ViewProjection = projectionData.ComputeViewProjectionMatrix();
+	ViewRect = projectionData.GetConstrainedViewRect();
+	return true;
+}
 
-	//// angle relative to camera view
-	float angleFovDegrees = FMath::RadiansToDegrees(angleFovRadians);
+FLockOnViewQuery ULockOnComponent::MakeViewQuery() const
+{
+	FLockOnViewQuery query;
+	query.IgnoreActor = OwnerCharacter;
+	query.MaxDistance = ViewQueryMaxDistance;
 
-	if (angleFovDegrees > Fov / 2.0)
+	if (OwnerCamComponent)
 	{
-		AngleDistance = 0.0f;
-		AngleDirection = 0.0f;
-		return false;
+		query.EyePosition = OwnerCamComponent->GetComponentLocation();
+		query.Forward = OwnerCamComponent->GetForwardVector();
+		query.FovDegrees = OwnerCamComponent->FieldOfView;
 	}
-
-	// angle direction
-	if (OwnerPlayerController)
+	else if (OwnerCharacter)
 	{
-		FVector2D screenPos;
-		bool targOnScreen = OwnerPlayerController->ProjectWorldLocationToScreen(TargPosition, screenPos);
-		if (!targOnScreen)
-			return false;
-
-		if (IsCurrentlyLockedOn)
-		{
-			FVector2D currentLockOnPos;
-			bool currentLockOn = OwnerPlayerController->ProjectWorldLocationToScreen(CurrentLockOnPos, currentLockOnPos);
-			if (currentLockOn)
-			{
-				// refer to current lock on target pos on screen
+		// ai and the server have no camera - use the pawn's eyes and control rotation
+		FRotator eyeRot;
+		OwnerCharacter->GetActorEyesViewPoint(query.EyePosition, eyeRot);
+		query.Forward = eyeRot.Vector();
+		query.FovDegrees = ViewQueryFov;
+	}
 
-				float angleDirRadians = FMath::Atan2(-(currentLockOnPos.X - screenPos.X), currentLockOnPos.Y - screenPos.Y);
-				AngleDirection = FMath::RadiansToDegrees(angleDirRadians);
-				AngleDistance = FMath::Abs(currentLockOnPos.X - screenPos.X) + FMath::Abs(currentLockOnPos.Y - screenPos.Y);
-				return true;
-			}
-		}
+	return query;
+}
 
-		// no current lock on target or they are off-screen
-		int32 screenX, screenY;
-		OwnerPlayerController->GetViewportSize(screenX, screenY);
+void ULockOnComponent::LockOnToBestTarget()
+{
+	if (ToggleOffReasons.IsValidIndex(0))
+		return;
 
-		float angleDirRadians = FMath::Atan2(-(screenX/2 - screenPos.X), screenY/2 - screenPos.Y);
-		AngleDirection = FMath::RadiansToDegrees(angleDirRadians);
-		AngleDistance = FMath::Abs(screenX/2 - screenPos.X) + FMath::Abs(screenY/2 - screenPos.Y);
-		return true;
-		
-	}
-	else
+	if (auto* targetSubsystem = GetWorld()->GetSubsystem<ULockOnTargetSubsystem>())
 	{
-		// ai units shouldnt be using this function
-		AngleDirection = 0.0f;
-		AngleDistance = 0.0f;
+		targetSubsystem->RequestBestTarget(MakeViewQuery(), FLockOnTargetFound::CreateUObject(this, &ULockOnComponent::OnBestTargetFound));
 	}
+}
 
-	return false;
+void ULockOnComponent::OnBestTargetFound(ULockOnTargSceneComponent* FoundTarget)
+{
+	if (!FoundTarget || ToggleOffReasons.IsValidIndex(0))
+		return;
+
+	// bots on the server can't lock on to an assassin they haven't noticed
+	auto* stealthPerception = GetWorld()->GetSubsystem<UStealthPerceptionSubsystem>();
+	if (stealthPerception && !stealthPerception->IsDetected(GetOwner(), FoundTarget->GetOwner()))
+		return;
+
+	SetLockOnTarget(FoundTarget);
+}
+
+bool ULockOnComponent::IsLockOnTargetInView(ULockOnTargSceneComponent* Target) const
+{
+	auto* targetSubsystem = GetWorld()->GetSubsystem<ULockOnTargetSubsystem>();
+	if (!Target || !targetSubsystem)
+		return false;
+
+	// the client's camera sits behind the pawn and sees wider than its eyes - be generous
+	FLockOnViewQuery query = MakeViewQuery();
+	query.FovDegrees = FMath::Min(query.FovDegrees + ViewQueryValidationSlack, 360.0f);
+	query.MaxDistance += ViewQueryMaxDistance;
+	return targetSubsystem->IsTargetInView(query, Target);
 }
 
-TMap<AKobWarCharacter*, FVector2D> ULockOnComponent::GetPotentialCharactersForLockOn()
+void ULockOnComponent::GetPotentialCharactersForLockOn(TArray<FLockOnCandidate>& OutCandidates)
 {
+	OutCandidates.Reset();
+
+	auto* targetSubsystem = GetWorld()->GetSubsystem<ULockOnTargetSubsystem>();
+	auto* visibilitySubsystem = GetWorld()->GetSubsystem<UVisibilitySubsystem>();
+	FMatrix viewProjection;
+	FIntRect viewRect;
+	if (!targetSubsystem || !visibilitySubsystem || !GetViewProjection(viewProjection, viewRect))
+		return;
+
 	FVector startPos = OwnerCamComponent->GetComponentLocation();
 	float currentTargDist = 2000.0f;
 	if (LockOnTarget)
@@ -293,66 +316,64 @@ TMap<AKobWarCharacter*, FVector2D> ULockOnComponent::GetPotentialCharactersForLo
 		currentTargDist += UKismetMathLibrary::Vector_Distance(startPos, LockOnTarget->GetComponentLocation());
 	}
 
-	FVector endPos = startPos + OwnerCamComponent->GetComponentRotation().Vector() * currentTargDist;
+	// same reach as the old box sweep (travel + half extent) as a cone over the registered targets
+	CandidateIndexScratch.Reset();
+	targetSubsystem->GatherCandidates(startPos, OwnerCamComponent->GetForwardVector(), currentTargDist * 2.0f, OwnerCamComponent->FieldOfView / 2.0f, OwnerCharacter, CandidateIndexScratch);
 
-	FVector boxExtent(currentTargDist, 800.0f, 800.0f);
+	if (CandidateIndexScratch.Num() == 0)
+		return;
 
-	TArray<FHitResult> hitresults;
-	TArray<AActor*> ignoreActors = TArray<AActor*>();
-	ignoreActors.Add(OwnerCharacter);
-	TArray<ECollisionChannel> queryTypes = TArray<ECollisionChannel>();
-	queryTypes.Add(ECollisionChannel::ECC_Pawn);
+	const TArray<FVector>& targetPositions = targetSubsystem->GetTargetPositions();
 
-	UKismetSystemLibrary::BoxTraceMulti(GetWorld(), startPos, endPos, boxExtent, OwnerCamComponent->GetComponentRotation(),
-		ETraceTypeQuery::TraceTypeQuery3, false, ignoreActors, IsShowingDebugLines ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None, hitresults, true, FLinearColor::Blue, FLinearColor::Black, 1.0f);
+	ProjectionBatch.Reset(CandidateIndexScratch.Num());
+	for (int32 i = 0; i < CandidateIndexScratch.Num(); i++)
+	{
+		ProjectionBatch.SetPosition(i, targetPositions[CandidateIndexScratch[i]]);
+	}
 
-	if (hitresults.Num() <= 0)
-		return TMap<AKobWarCharacter*, FVector2D>();
+	// measure from the current lock on target, or the screen center if there is none or they are off-screen
+	FVector2D referenceScreenPos = FVector2D(viewRect.Min + viewRect.Max) * 0.5f;
+	FVector2D currentLockOnPos;
+	if (LockOnTarget && FSceneView::ProjectWorldToScreen(LockOnTarget->GetComponentLocation(), viewRect, viewProjection, currentLockOnPos))
+	{
+		referenceScreenPos = currentLockOnPos;
+	}
 
-	TMap<AKobWarCharacter*, FVector2D> availableCharacters = TMap<AKobWarCharacter*, FVector2D>();
+	ULockOnTargetSubsystem::ProjectBatch(viewProjection, viewRect, referenceScreenPos, ProjectionBatch);
 
-	for (auto& result : hitresults)
+	for (int32 i = 0; i < CandidateIndexScratch.Num(); i++)
 	{
-		// verify if the trace is visible for this player
-		FVector visioncheckStartPos = startPos;
-		FVector visioncheckEndPos;
-		AKobWarCharacter* targetChar = Cast<AKobWarCharacter>(result.Actor);
+		if (!ProjectionBatch.OnScreen[i])
+			continue;
 
-		if (targetChar)
-		{
-			auto* targLockOnComponent = targetChar->GetLockOnTargScene();
-			if (!targLockOnComponent)
-				continue;
+		const int32 index = CandidateIndexScratch[i];
+		AKobWarCharacter* targetChar = Cast<AKobWarCharacter>(targetSubsystem->GetTargetOwner(index));
+		auto* targLockOnComponent = targetSubsystem->GetTarget(index);
+		if (!targetChar || targetChar->GetLockOnTargScene() != targLockOnComponent)
+			continue;
 
-			FVector targPos = targLockOnComponent->GetComponentLocation();
+		// verify if the target is visible for this player - reuses recent answers for the same pair
+		const bool visible = visibilitySubsystem->TestVisibility(OwnerCharacter, targetChar, startPos, targetPositions[index]);
 
-			float angleDist;
-			float angleDir;
-			if (!IsPosInFov(startPos, OwnerCamComponent->GetComponentRotation(), LockOnTarget != nullptr, LockOnTarget != nullptr ? LockOnTarget->GetComponentLocation() : FVector::ZeroVector, targPos, OwnerCamComponent->FieldOfView, angleDist, angleDir))
-			{
-				// not in fov, return
-				continue;
-			}
+#if ENABLE_DRAW_DEBUG
+		if (IsShowingDebugLines)
+		{
+			DrawDebugLine(GetWorld(), startPos, targetPositions[index], visible ? FColor::Green : FColor::Red, false, 1.0f);
+		}
+#endif
 
-			visioncheckEndPos = targPos;
-			FHitResult visCheckHitResult;
-			TArray<AActor*> ignoreActorsVis = TArray<AActor*>();
-			ignoreActorsVis.Add(OwnerCharacter);
-			ignoreActorsVis.Add(targetChar);
-			bool visResult = UKismetSystemLibrary::LineTraceSingle(GetWorld(), visioncheckStartPos, visioncheckEndPos, UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_Visibility), false, ignoreActorsVis, IsShowingDebugLines ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None, visCheckHitResult, true, FLinearColor::Green, FLinearColor::Red, 1.0f);
-			if (visResult)
-			{
-				// vision blocked
-				continue;
-			}
-			else
-			{
-				availableCharacters.Add(targetChar, FVector2D(angleDist, angleDir));
-			}
+		if (!visible)
+		{
+			// vision blocked
+			continue;
 		}
-	}
 
-	return availableCharacters;
+		FLockOnCandidate& candidate = OutCandidates.AddDefaulted_GetRef();
+		candidate.Character = targetChar;
+		candidate.Target = targLockOnComponent;
+		candidate.AngleDistance = ProjectionBatch.AngleDistance[i];
+		candidate.ScreenDirection = FVector2D(ProjectionBatch.DirX[i], ProjectionBatch.DirY[i]);
+	}
 }
 
 void ULockOnComponent::UpdateOwnerLockOnState(bool Toggle)
@@ -363,20 +384,22 @@ void ULockOnComponent::UpdateOwnerLockOnState(bool Toggle)
 	}
 }
 
-void ULockOnComponent::InterpCamToTargetStep(float DeltaTime)
+void ULockOnComponent::InitCameraModifier()
 {
-	if (!LockOnTarget || !OwnerCharacter || !OwnerCamComponent || !OwnerSpringArmComponent)
-	{
+	APlayerCameraManager* cameraManager = OwnerPlayerController ? OwnerPlayerController->PlayerCameraManager : nullptr;
+	if (!cameraManager)
 		return;
+
+	// a pooled character can be possessed by a controller that already has one
+	LockOnCameraModifier = Cast<ULockOnCameraModifier>(cameraManager->FindCameraModifierByClass(ULockOnCameraModifier::StaticClass()));
+	if (!LockOnCameraModifier)
+	{
+		LockOnCameraModifier = Cast<ULockOnCameraModifier>(cameraManager->AddNewCameraModifier(ULockOnCameraModifier::StaticClass()));
 	}
 
-	FRotator targSpringArmRot = UKismetMathLibrary::FindLookAtRotation(OwnerSpringArmComponent->GetComponentLocation() - FVector(0.0f, 0.0f, -100.0f), LockOnTarget->GetComponentLocation() - FVector(0.0f, 0.0f, -50.0f));
-	if (OwnerCharacter->GetController())
+	if (LockOnCameraModifier)
 	{
-		FRotator controllerRot = OwnerCharacter->GetController()->GetControlRotation();
-		controllerRot.Add(LockOnOffset.Y, LockOnOffset.X, 0);
-		FRotator newRot = FMath::RInterpTo(controllerRot, targSpringArmRot, DeltaTime, LockOnRotSpeed);
-		OwnerCharacter->GetController()->SetControlRotation(newRot);
+		LockOnCameraModifier->SetLockOnTarget(LockOnTarget);
 	}
 }
 
@@ -394,20 +417,37 @@ void ULockOnComponent::EndLockOnVerifyTimer()
 
 void ULockOnComponent::LockOnVerify()
 {
-	if (!LockOnTarget || !OwnerCamComponent || !OwnerCharacter)
+	if (!LockOnTarget || !OwnerCharacter)
 	{
 		EndLockOnVerifyTimer();
+		return;
 	}
 
-	FVector startPos = OwnerCamComponent->GetComponentLocation();
-	FVector endPos = LockOnTarget->GetComponentLocation();
+	// a target that went into the pool or was hidden is lost straight away, not after two blocked traces
+	auto* targetCharacter = Cast<AKobWarCharacter>(LockOnTarget->GetOwner());
+	if (!targetCharacter || targetCharacter->IsHidden() || targetCharacter->IsInPawnPool())
+	{
+		SetLockOnTarget(nullptr);
+		return;
+	}
+
+	auto* visibilitySubsystem = GetWorld()->GetSubsystem<UVisibilitySubsystem>();
+	if (!visibilitySubsystem)
+		return;
+
+	visibilitySubsystem->RequestVisibility(OwnerCharacter, LockOnTarget->GetOwner(), MakeViewQuery().EyePosition, LockOnTarget->GetComponentLocation(),
+		FVisibilityResult::CreateUObject(this, &ULockOnComponent::OnLockOnVerifyResult, LockOnTarget));
+}
 
-	FHitResult visCheckHitResult;
-	TArray<AActor*> ignoreActorsVis = TArray<AActor*>();
-	ignoreActorsVis.Add(OwnerCharacter);
-	ignoreActorsVis.Add(LockOnTarget->GetOwner());
-	bool visResult = UKismetSystemLibrary::LineTraceSingle(GetWorld(), startPos, endPos, UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_Visibility), false, ignoreActorsVis, IsShowingDebugLines ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None, visCheckHitResult, true, FLinearColor::Green, FLinearColor::Red, 1.0f);
-	if (visResult)
+void ULockOnComponent::OnLockOnVerifyResult(bool Visible, ULockOnTargSceneComponent* VerifiedTarget)
+{
+	if (!LockOnTarget || LockOnTarget != VerifiedTarget)
+	{
+		// switched or unlocked while the trace was in flight
+		return;
+	}
+
+	if (!Visible)
 	{
 		NoVisionVerifyCount++;
 
@@ -449,14 +489,18 @@ void ULockOnComponent::PauseForReason(bool Toggle, FName Reason)
 	}
 }
 
-// Called every frame
-void ULockOnComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void ULockOnComponent::ResetForPool()
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	ToggleOffReasons.Empty();
 
-	InterpCamToTargetStep(DeltaTime);
+	if (LockOnTarget)
+	{
+		SetLockOnTarget(nullptr);
+	}
 
-	//InterpLockOnOffset(DeltaTime);
+	GetWorld()->GetTimerManager().ClearTimer(LockSwitchTimer);
+	IsLockSwitchTimerActive = false;
+	NoVisionVerifyCount = 0;
 }
 
 bool ULockOnComponent::GetCurrentLockOnTarget(ULockOnTargSceneComponent*& TargetComponent)
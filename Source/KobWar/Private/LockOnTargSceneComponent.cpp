@@ -2,15 +2,13 @@
 
 
 #include "LockOnTargSceneComponent.h"
+#include "LockOnTargetSubsystem.h"
 
 // Sets default values for this component's properties
 ULockOnTargSceneComponent::ULockOnTargSceneComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
-
-	// ...
+	// positions are read by ULockOnTargetSubsystem, nothing to do per frame
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 
@@ -19,16 +17,18 @@ void ULockOnTargSceneComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...
-	
+	if (auto* targetSubsystem = GetWorld()->GetSubsystem<ULockOnTargetSubsystem>())
+	{
+		targetSubsystem->RegisterTarget(this);
+	}
 }
 
-
-// Called every frame
-void ULockOnTargSceneComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void ULockOnTargSceneComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (auto* targetSubsystem = GetWorld()->GetSubsystem<ULockOnTargetSubsystem>())
+	{
+		targetSubsystem->UnregisterTarget(this);
+	}
 
-	// ...
+	Super::EndPlay(EndPlayReason);
 }
-
@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LockOnTargetSubsystem.h"
+#include "LockOnTargSceneComponent.h"
+#include "Async/ParallelFor.h"
+
+void FLockOnProjectionBatch::Reset(const int32 NewNum)
+{
+	Num = NewNum;
+
+	// padded to the vector width so the kernel never needs a scalar tail
+	const int32 paddedNum = Align(NewNum, 4);
+	X.SetNumZeroed(paddedNum, false);
+	Y.SetNumZeroed(paddedNum, false);
+	Z.SetNumZeroed(paddedNum, false);
+	DirX.SetNumUninitialized(paddedNum, false);
+	DirY.SetNumUninitialized(paddedNum, false);
+	AngleDistance.SetNumUninitialized(paddedNum, false);
+	OnScreen.SetNumUninitialized(paddedNum, false);
+}
+
+void FLockOnProjectionBatch::SetPosition(const int32 Index, const FVector& Position)
+{
+	X[Index] = Position.X;
+	Y[Index] = Position.Y;
+	Z[Index] = Position.Z;
+}
+
+bool ULockOnTargetSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* world = Cast<UWorld>(Outer);
+	return world && world->IsGameWorld();
+}
+
+bool ULockOnTargetSubsystem::IsTickable() const
+{
+	return PendingQueries.Num() > 0 && GetWorld();
+}
+
+TStatId ULockOnTargetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULockOnTargetSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* ULockOnTargetSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+void ULockOnTargetSubsystem::Tick(float DeltaTime)
+{
+	FindBestTargets(PendingQueries, QueryResults);
+
+	// callbacks may queue new queries for next frame
+	TArray<FLockOnTargetFound> callbacks = MoveTemp(PendingCallbacks);
+	PendingQueries.Reset();
+	PendingCallbacks.Reset();
+
+	for (int32 i = 0; i < callbacks.Num(); i++)
+	{
+		callbacks[i].ExecuteIfBound(QueryResults[i]);
+	}
+}
+
+void ULockOnTargetSubsystem::RegisterTarget(ULockOnTargSceneComponent* Target)
+{
+	if (!Target || Targets.Contains(Target))
+		return;
+
+	Targets.Add(Target);
+	TargetOwners.Add(Target->GetOwner());
+	TargetPositions.Add(Target->GetComponentLocation());
+}
+
+void ULockOnTargetSubsystem::UnregisterTarget(ULockOnTargSceneComponent* Target)
+{
+	const int32 index = Targets.IndexOfByKey(Target);
+	if (index == INDEX_NONE)
+		return;
+
+	Targets.RemoveAtSwap(index, 1, false);
+	TargetOwners.RemoveAtSwap(index, 1, false);
+	TargetPositions.RemoveAtSwap(index, 1, false);
+}
+
+const TArray<FVector>& ULockOnTargetSubsystem::GetTargetPositions()
+{
+	RefreshPositions();
+	return TargetPositions;
+}
+
+void ULockOnTargetSubsystem::RefreshPositions()
+{
+	if (PositionsFrame == GFrameCounter)
+		return;
+
+	PositionsFrame = GFrameCounter;
+
+	for (int32 i = 0; i < Targets.Num(); i++)
+	{
+		TargetPositions[i] = Targets[i]->GetComponentLocation();
+	}
+}
+
+void ULockOnTargetSubsystem::GatherCandidates(const FVector& ViewPosition, const FVector& ViewDirection, const float MaxDistance, const float HalfFovDegrees, const AActor* IgnoreActor, TArray<int32>& OutIndices)
+{
+	RefreshPositions();
+
+	const float maxDistSq = FMath::Square(MaxDistance);
+	const float cosHalfFov = FMath::Cos(FMath::DegreesToRadians(HalfFovDegrees));
+	const FVector viewDir = ViewDirection.GetSafeNormal();
+
+	for (int32 i = 0; i < TargetPositions.Num(); i++)
+	{
+		const FVector toTarget = TargetPositions[i] - ViewPosition;
+		const float distSq = toTarget.SizeSquared();
+		if (distSq > maxDistSq || distSq < KINDA_SMALL_NUMBER)
+			continue;
+
+		// dot >= cos * |d| compared squared, so no sqrt or acos per target
+		const float dot = FVector::DotProduct(viewDir, toTarget);
+		if (dot <= 0.0f || dot * dot < cosHalfFov * cosHalfFov * distSq)
+			continue;
+
+		const AActor* owner = TargetOwners[i];
+		if (!owner || owner == IgnoreActor || owner->IsHidden())
+			continue;
+
+		OutIndices.Add(i);
+	}
+}
+
+void ULockOnTargetSubsystem::ProjectBatch(const FMatrix& ViewProjection, const FIntRect& ViewRect, const FVector2D& ReferenceScreenPos, FLockOnProjectionBatch& Batch)
+{
+	// row vector convention - clip = x * M[0] + y * M[1] + z * M[2] + M[3], only the x, y and w columns are needed
+	const VectorRegister m00 = VectorSetFloat1(ViewProjection.M[0][0]);
+	const VectorRegister m10 = VectorSetFloat1(ViewProjection.M[1][0]);
+	const VectorRegister m20 = VectorSetFloat1(ViewProjection.M[2][0]);
+	const VectorRegister m30 = VectorSetFloat1(ViewProjection.M[3][0]);
+	const VectorRegister m01 = VectorSetFloat1(ViewProjection.M[0][1]);
+	const VectorRegister m11 = VectorSetFloat1(ViewProjection.M[1][1]);
+	const VectorRegister m21 = VectorSetFloat1(ViewProjection.M[2][1]);
+	const VectorRegister m31 = VectorSetFloat1(ViewProjection.M[3][1]);
+	const VectorRegister m03 = VectorSetFloat1(ViewProjection.M[0][3]);
+	const VectorRegister m13 = VectorSetFloat1(ViewProjection.M[1][3]);
+	const VectorRegister m23 = VectorSetFloat1(ViewProjection.M[2][3]);
+	const VectorRegister m33 = VectorSetFloat1(ViewProjection.M[3][3]);
+
+	// ndc to pixels the same way FSceneView::ProjectWorldToScreen does, with the reference point folded into the offset
+	const float halfWidth = ViewRect.Width() * 0.5f;
+	const float halfHeight = ViewRect.Height() * 0.5f;
+	const VectorRegister scaleX = VectorSetFloat1(halfWidth);
+	const VectorRegister scaleY = VectorSetFloat1(-halfHeight);
+	const VectorRegister offsetX = VectorSetFloat1(ViewRect.Min.X + halfWidth - ReferenceScreenPos.X);
+	const VectorRegister offsetY = VectorSetFloat1(ViewRect.Min.Y + halfHeight - ReferenceScreenPos.Y);
+
+	const VectorRegister minW = VectorSetFloat1(KINDA_SMALL_NUMBER);
+	const VectorRegister minLenSq = VectorSetFloat1(SMALL_NUMBER);
+	const VectorRegister one = VectorOne();
+
+	for (int32 i = 0; i < Batch.Num; i += 4)
+	{
+		const VectorRegister x = VectorLoad(&Batch.X[i]);
+		const VectorRegister y = VectorLoad(&Batch.Y[i]);
+		const VectorRegister z = VectorLoad(&Batch.Z[i]);
+
+		const VectorRegister clipX = VectorMultiplyAdd(x, m00, VectorMultiplyAdd(y, m10, VectorMultiplyAdd(z, m20, m30)));
+		const VectorRegister clipY = VectorMultiplyAdd(x, m01, VectorMultiplyAdd(y, m11, VectorMultiplyAdd(z, m21, m31)));
+		const VectorRegister clipW = VectorMultiplyAdd(x, m03, VectorMultiplyAdd(y, m13, VectorMultiplyAdd(z, m23, m33)));
+
+		const VectorRegister invW = VectorReciprocalAccurate(VectorMax(clipW, minW));
+		const VectorRegister ndcX = VectorMultiply(clipX, invW);
+		const VectorRegister ndcY = VectorMultiply(clipY, invW);
+
+		// in front of the camera and inside the view rect
+		const VectorRegister onScreen = VectorBitwiseAnd(VectorCompareGT(clipW, minW),
+			VectorBitwiseAnd(VectorCompareLE(VectorAbs(ndcX), one), VectorCompareLE(VectorAbs(ndcY), one)));
+
+		const VectorRegister deltaX = VectorMultiplyAdd(ndcX, scaleX, offsetX);
+		const VectorRegister deltaY = VectorMultiplyAdd(ndcY, scaleY, offsetY);
+
+		const VectorRegister lenSq = VectorMax(VectorMultiplyAdd(deltaX, deltaX, VectorMultiply(deltaY, deltaY)), minLenSq);
+		const VectorRegister invLen = VectorReciprocalSqrtAccurate(lenSq);
+
+		VectorStore(VectorMultiply(deltaX, invLen), &Batch.DirX[i]);
+		VectorStore(VectorMultiply(deltaY, invLen), &Batch.DirY[i]);
+		VectorStore(VectorAdd(VectorAbs(deltaX), VectorAbs(deltaY)), &Batch.AngleDistance[i]);
+
+		const int32 mask = VectorMaskBits(onScreen);
+		Batch.OnScreen[i] = (mask & 1) != 0;
+		Batch.OnScreen[i + 1] = (mask & 2) != 0;
+		Batch.OnScreen[i + 2] = (mask & 4) != 0;
+		Batch.OnScreen[i + 3] = (mask & 8) != 0;
+	}
+}
+
+int32 ULockOnTargetSubsystem::ScoreQuery(const FLockOnViewQuery& Query) const
+{
+	// read only - runs on worker threads, positions were refreshed before the ParallelFor
+	const float maxDistSq = FMath::Square(Query.MaxDistance);
+	const float cosHalfFov = FMath::Cos(FMath::DegreesToRadians(Query.FovDegrees * 0.5f));
+	const FVector forward = Query.Forward.GetSafeNormal();
+
+	int32 bestIndex = INDEX_NONE;
+	float bestCos = cosHalfFov;
+
+	for (int32 i = 0; i < TargetPositions.Num(); i++)
+	{
+		const FVector toTarget = TargetPositions[i] - Query.EyePosition;
+		const float distSq = toTarget.SizeSquared();
+		if (distSq > maxDistSq || distSq < KINDA_SMALL_NUMBER)
+			continue;
+
+		const float cosAngle = FVector::DotProduct(forward, toTarget) * FMath::InvSqrt(distSq);
+		if (cosAngle < bestCos)
+			continue;
+
+		const AActor* owner = TargetOwners[i];
+		if (!owner || owner == Query.IgnoreActor || owner->IsHidden())
+			continue;
+
+		bestCos = cosAngle;
+		bestIndex = i;
+	}
+
+	return bestIndex;
+}
+
+void ULockOnTargetSubsystem::FindBestTargets(const TArray<FLockOnViewQuery>& Queries, TArray<ULockOnTargSceneComponent*>& OutTargets)
+{
+	RefreshPositions();
+
+	OutTargets.SetNumUninitialized(Queries.Num(), false);
+
+	ParallelFor(Queries.Num(), [this, &Queries, &OutTargets](int32 QueryIndex)
+	{
+		const int32 bestIndex = ScoreQuery(Queries[QueryIndex]);
+		OutTargets[QueryIndex] = bestIndex != INDEX_NONE ? Targets[bestIndex] : nullptr;
+	});
+}
+
+ULockOnTargSceneComponent* ULockOnTargetSubsystem::FindBestTarget(const FLockOnViewQuery& Query)
+{
+	RefreshPositions();
+
+	const int32 bestIndex = ScoreQuery(Query);
+	return bestIndex != INDEX_NONE ? Targets[bestIndex] : nullptr;
+}
+
+void ULockOnTargetSubsystem::RequestBestTarget(const FLockOnViewQuery& Query, FLockOnTargetFound Callback)
+{
+	PendingQueries.Add(Query);
+	PendingCallbacks.Add(MoveTemp(Callback));
+}
+
+bool ULockOnTargetSubsystem::IsTargetInView(const FLockOnViewQuery& Query, const ULockOnTargSceneComponent* Target)
+{
+	const int32 index = Targets.IndexOfByKey(Target);
+	if (index == INDEX_NONE)
+		return false;
+
+	RefreshPositions();
+
+	const FVector toTarget = TargetPositions[index] - Query.EyePosition;
+	const float distSq = toTarget.SizeSquared();
+	if (distSq > FMath::Square(Query.MaxDistance))
+		return false;
+
+	const float cosHalfFov = FMath::Cos(FMath::DegreesToRadians(Query.FovDegrees * 0.5f));
+	const float dot = FVector::DotProduct(Query.Forward.GetSafeNormal(), toTarget);
+	return dot > 0.0f && dot * dot >= cosHalfFov * cosHalfFov * distSq;
+}
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MovementSnapshotComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+bool FMovementSnapshotStruct::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bool positionSuccess = true;
+	bool velocitySuccess = true;
+
+	Position.NetSerialize(Ar, Map, positionSuccess);
+	Velocity.NetSerialize(Ar, Map, velocitySuccess);
+	Ar << Yaw;
+	Ar << ServerTime;
+
+	bOutSuccess = positionSuccess && velocitySuccess;
+	return true;
+}
+
+// Sets default values for this component's properties
+UMovementSnapshotComponent::UMovementSnapshotComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	SetIsReplicatedByDefault(true);
+}
+
+void UMovementSnapshotComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams sharedParams_SkipOwner;
+	sharedParams_SkipOwner.bIsPushBased = true;
+	sharedParams_SkipOwner.Condition = COND_SkipOwner;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(UMovementSnapshotComponent, Snapshot, sharedParams_SkipOwner);
+}
+
+// Called when the game starts
+void UMovementSnapshotComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerCharacter = Cast<ACharacter>(GetOwner());
+	if (!OwnerCharacter || !UseCompactMovementReplication)
+		return;
+
+	if (OwnerCharacter->HasAuthority())
+	{
+		OwnerCharacter->SetReplicateMovement(false);
+		SetComponentTickEnabled(GetNetMode() != NM_Standalone);
+	}
+	else
+	{
+		// clients check the role every tick - a pooled character can change between simulated and autonomous
+		SetComponentTickEnabled(true);
+	}
+}
+
+// Called every frame
+void UMovementSnapshotComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!OwnerCharacter)
+		return;
+
+	if (OwnerCharacter->HasAuthority())
+	{
+		// possession and Blueprint setup can turn it back on; two position streams would fight on the proxies
+		if (OwnerCharacter->IsReplicatingMovement())
+		{
+			OwnerCharacter->SetReplicateMovement(false);
+		}
+
+		WriteServerSnapshot();
+		return;
+	}
+
+	// the movement component would integrate the velocity a second time on simulated proxies
+	UCharacterMovementComponent* movementComp = OwnerCharacter->GetCharacterMovement();
+	const bool isSimulated = OwnerCharacter->GetLocalRole() == ROLE_SimulatedProxy;
+	if (movementComp->IsComponentTickEnabled() == isSimulated)
+	{
+		movementComp->SetComponentTickEnabled(!isSimulated);
+		ClearSnapshotBuffer();
+	}
+
+	if (isSimulated)
+	{
+		InterpolateSimulatedProxy();
+	}
+}
+
+void UMovementSnapshotComponent::ClearSnapshotBuffer()
+{
+	SnapshotBuffer.Reset();
+}
+
+bool UMovementSnapshotComponent::IsDrivingSimulatedProxy() const
+{
+	return UseCompactMovementReplication && OwnerCharacter && OwnerCharacter->GetLocalRole() == ROLE_SimulatedProxy;
+}
+
+void UMovementSnapshotComponent::WriteServerSnapshot()
+{
+	const FVector position = OwnerCharacter->GetActorLocation();
+	const FVector velocity = OwnerCharacter->GetVelocity();
+	const uint16 yaw = FRotator::CompressAxisToShort(OwnerCharacter->GetActorRotation().Yaw);
+
+	// compare at the quantized precision so an idle character stops dirtying the property
+	if (position.Equals(Snapshot.Position, 0.5f) && velocity.Equals(Snapshot.Velocity, 0.5f) && yaw == Snapshot.Yaw)
+		return;
+
+	Snapshot.Position = position;
+	Snapshot.Velocity = velocity;
+	Snapshot.Yaw = yaw;
+	Snapshot.ServerTime = GetServerTime();
+	MARK_PROPERTY_DIRTY_FROM_NAME(UMovementSnapshotComponent, Snapshot, this);
+}
+
+void UMovementSnapshotComponent::OnRep_Snapshot()
+{
+	if (SnapshotBuffer.Num() > 0 && Snapshot.ServerTime <= SnapshotBuffer.Last().ServerTime)
+		return;
+
+	SnapshotBuffer.Add(Snapshot);
+
+	if (SnapshotBuffer.Num() > MaxBufferedSnapshots)
+	{
+		SnapshotBuffer.RemoveAt(0, SnapshotBuffer.Num() - MaxBufferedSnapshots, false);
+	}
+}
+
+void UMovementSnapshotComponent::InterpolateSimulatedProxy()
+{
+	if (SnapshotBuffer.Num() == 0)
+		return;
+
+	const float renderTime = GetServerTime() - InterpolationDelay;
+
+	FVector position;
+	FVector velocity;
+	float yaw;
+
+	const FMovementSnapshotStruct& newest = SnapshotBuffer.Last();
+	if (renderTime >= newest.ServerTime)
+	{
+		// ran out of snapshots - keep going on the last velocity for a short while
+		const float extrapolateTime = FMath::Min(renderTime - newest.ServerTime, MaxExtrapolationTime);
+		position = newest.Position + newest.Velocity * extrapolateTime;
+		velocity = extrapolateTime < MaxExtrapolationTime ? (FVector)newest.Velocity : FVector::ZeroVector;
+		yaw = FRotator::DecompressAxisFromShort(newest.Yaw);
+	}
+	else if (renderTime <= SnapshotBuffer[0].ServerTime)
+	{
+		position = SnapshotBuffer[0].Position;
+		velocity = SnapshotBuffer[0].Velocity;
+		yaw = FRotator::DecompressAxisFromShort(SnapshotBuffer[0].Yaw);
+	}
+	else
+	{
+		int32 nextIndex = 1;
+		while (nextIndex < SnapshotBuffer.Num() - 1 && SnapshotBuffer[nextIndex].ServerTime < renderTime)
+		{
+			nextIndex++;
+		}
+
+		const FMovementSnapshotStruct& from = SnapshotBuffer[nextIndex - 1];
+		const FMovementSnapshotStruct& to = SnapshotBuffer[nextIndex];
+		const float alpha = FMath::Clamp((renderTime - from.ServerTime) / FMath::Max(to.ServerTime - from.ServerTime, KINDA_SMALL_NUMBER), 0.0f, 1.0f);
+
+		position = FMath::Lerp<FVector>(from.Position, to.Position, alpha);
+		velocity = FMath::Lerp<FVector>(from.Velocity, to.Velocity, alpha);
+		yaw = FMath::Lerp(FRotator(0.0f, FRotator::DecompressAxisFromShort(from.Yaw), 0.0f), FRotator(0.0f, FRotator::DecompressAxisFromShort(to.Yaw), 0.0f), alpha).Yaw;
+
+		// everything older than the pair being played is no longer needed
+		if (nextIndex > 1)
+		{
+			SnapshotBuffer.RemoveAt(0, nextIndex - 1, false);
+		}
+	}
+
+	OwnerCharacter->SetActorLocationAndRotation(position, FRotator(0.0f, yaw, 0.0f), false, nullptr, ETeleportType::None);
+	OwnerCharacter->GetCharacterMovement()->Velocity = velocity;
+}
+
+float UMovementSnapshotComponent::GetServerTime() const
+{
+	UWorld* world = GetWorld();
+	if (AGameStateBase* gameState = world->GetGameState())
+	{
+		return gameState->GetServerWorldTimeSeconds();
+	}
+	return world->GetTimeSeconds();
+}
@@ -0,0 +1,258 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MovementValidationSubsystem.h"
+#include "KobWar/KobWarCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/GameSession.h"
+
+bool UMovementValidationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* world = Cast<UWorld>(Outer);
+	return world && world->IsGameWorld();
+}
+
+void UMovementValidationSubsystem::Deinitialize()
+{
+	Characters.Empty();
+	Positions.Empty();
+	LastValidPositions.Empty();
+	LastValidTimes.Empty();
+	AllowedSpeeds.Empty();
+	ViolationScores.Empty();
+	CorrectionCounts.Empty();
+	IsWalking.Empty();
+	HasWarned.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UMovementValidationSubsystem::IsTickable() const
+{
+	UWorld* world = GetWorld();
+	if (!world || Characters.Num() == 0)
+		return false;
+
+	// only a server with remote clients has anything to validate
+	const ENetMode netMode = world->GetNetMode();
+	return netMode == NM_DedicatedServer || netMode == NM_ListenServer;
+}
+
+TStatId UMovementValidationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMovementValidationSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UMovementValidationSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+void UMovementValidationSubsystem::RegisterCharacter(AKobWarCharacter* Character)
+{
+	if (!Character || Characters.Contains(Character))
+		return;
+
+	const FVector location = Character->GetActorLocation();
+
+	Characters.Add(Character);
+	Positions.Add(location);
+	LastValidPositions.Add(location);
+	LastValidTimes.Add(GetWorld()->GetTimeSeconds());
+	AllowedSpeeds.Add(-1.0f);
+	ViolationScores.Add(0.0f);
+	CorrectionCounts.Add(0);
+	IsWalking.Add(false);
+	HasWarned.Add(false);
+}
+
+void UMovementValidationSubsystem::UnregisterCharacter(AKobWarCharacter* Character)
+{
+	const int32 index = Characters.IndexOfByKey(Character);
+	if (index != INDEX_NONE)
+	{
+		RemoveAtSwap(index);
+	}
+}
+
+void UMovementValidationSubsystem::ResetCharacter(AKobWarCharacter* Character)
+{
+	const int32 index = Characters.IndexOfByKey(Character);
+	if (index == INDEX_NONE)
+		return;
+
+	Positions[index] = Character->GetActorLocation();
+	LastValidPositions[index] = Positions[index];
+	LastValidTimes[index] = GetWorld()->GetTimeSeconds();
+	ViolationScores[index] = 0.0f;
+	CorrectionCounts[index] = 0;
+	HasWarned[index] = false;
+}
+
+void UMovementValidationSubsystem::RemoveAtSwap(int32 Index)
+{
+	Characters.RemoveAtSwap(Index, 1, false);
+	Positions.RemoveAtSwap(Index, 1, false);
+	LastValidPositions.RemoveAtSwap(Index, 1, false);
+	LastValidTimes.RemoveAtSwap(Index, 1, false);
+	AllowedSpeeds.RemoveAtSwap(Index, 1, false);
+	ViolationScores.RemoveAtSwap(Index, 1, false);
+	CorrectionCounts.RemoveAtSwap(Index, 1, false);
+	IsWalking.RemoveAtSwap(Index, 1, false);
+	HasWarned.RemoveAtSwap(Index, 1, false);
+}
+
+void UMovementValidationSubsystem::GatherCharacterData()
+{
+	for (int32 i = Characters.Num() - 1; i >= 0; i--)
+	{
+		AKobWarCharacter* character = Characters[i].Get();
+		if (!character)
+		{
+			RemoveAtSwap(i);
+			continue;
+		}
+
+		Positions[i] = character->GetActorLocation();
+
+		// the server trusts its own pawns, and pooled or unpossessed characters are only moved by the server
+		if (character->IsLocallyControlled() || character->IsInPawnPool() || !character->GetController())
+		{
+			AllowedSpeeds[i] = -1.0f;
+			continue;
+		}
+
+		UCharacterMovementComponent* movementComp = character->GetCharacterMovement();
+		float allowedSpeed = FMath::Max(character->GetTargetMoveSpeed(), movementComp->GetMaxSpeed()) * SpeedTolerance;
+		if (character->GetState() == ECharacterState::Acting)
+		{
+			allowedSpeed *= ActingSpeedMultiplier;
+		}
+
+		AllowedSpeeds[i] = allowedSpeed;
+		IsWalking[i] = movementComp->IsMovingOnGround();
+	}
+}
+
+void UMovementValidationSubsystem::Tick(float DeltaTime)
+{
+	GatherCharacterData();
+
+	const float now = GetWorld()->GetTimeSeconds();
+	const float teleportDistSq = FMath::Square(TeleportDistance);
+	int32 floorSamples = 0;
+
+	for (int32 i = 0; i < Characters.Num(); i++)
+	{
+		if (AllowedSpeeds[i] < 0.0f)
+		{
+			LastValidPositions[i] = Positions[i];
+			LastValidTimes[i] = now;
+			continue;
+		}
+
+		ViolationScores[i] = FMath::Max(0.0f, ViolationScores[i] - ViolationDecayPerSecond * DeltaTime);
+		if (ViolationScores[i] <= 0.0f)
+		{
+			CorrectionCounts[i] = 0;
+			HasWarned[i] = false;
+		}
+
+		const FVector delta = Positions[i] - LastValidPositions[i];
+		if (delta.IsNearlyZero())
+		{
+			LastValidTimes[i] = now;
+			continue;
+		}
+
+		// elapsed is capped so a client that stalled can't bank a long distance budget
+		const float elapsed = FMath::Min(now - LastValidTimes[i], 1.0f);
+		const float allowedDist = AllowedSpeeds[i] * elapsed + DistanceSlack;
+
+		if (delta.SizeSquared() > teleportDistSq + FMath::Square(allowedDist))
+		{
+			// always corrected, so only the score is added here - one correction per teleport
+			AddViolationScore(i, TEXT("teleport"));
+			ApplyCorrection(i);
+			continue;
+		}
+
+		if (delta.SizeSquared2D() > FMath::Square(allowedDist))
+		{
+			EscalateViolation(i, TEXT("speed"));
+			continue;
+		}
+
+		if (IsWalking[i] && delta.Z > MaxStepUpHeight && floorSamples < MaxFloorSamplesPerFrame)
+		{
+			floorSamples++;
+
+			AKobWarCharacter* character = Characters[i].Get();
+			const FVector start = Positions[i];
+			const FVector end = start - FVector(0.0f, 0.0f, character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() + FloorCheckDistance);
+
+			FCollisionQueryParams queryParams(SCENE_QUERY_STAT(MovementValidationFloor), false, character);
+			if (!GetWorld()->LineTraceTestByChannel(start, end, ECC_Visibility, queryParams))
+			{
+				EscalateViolation(i, TEXT("no floor"));
+				continue;
+			}
+		}
+
+		LastValidPositions[i] = Positions[i];
+		LastValidTimes[i] = now;
+	}
+}
+
+bool UMovementValidationSubsystem::AddViolationScore(int32 Index, const TCHAR* Reason)
+{
+	ViolationScores[Index] += 1.0f;
+
+	if (ViolationScores[Index] >= CorrectViolationScore)
+		return true;
+
+	if (ViolationScores[Index] >= WarnViolationScore && !HasWarned[Index])
+	{
+		HasWarned[Index] = true;
+		UE_LOG(LogTemp, Warning, TEXT("UMovementValidationSubsystem: %s failed %s check"), *GetNameSafe(Characters[Index].Get()), Reason);
+	}
+	return false;
+}
+
+void UMovementValidationSubsystem::EscalateViolation(int32 Index, const TCHAR* Reason)
+{
+	if (AddViolationScore(Index, Reason))
+	{
+		ApplyCorrection(Index);
+	}
+}
+
+void UMovementValidationSubsystem::ApplyCorrection(int32 Index)
+{
+	AKobWarCharacter* character = Characters[Index].Get();
+	if (!character)
+		return;
+
+	const FVector correctedPos = LastValidPositions[Index];
+	character->SetActorLocation(correctedPos, false, nullptr, ETeleportType::TeleportPhysics);
+	character->ClientCorrectPosition(correctedPos);
+
+	Positions[Index] = correctedPos;
+	LastValidTimes[Index] = GetWorld()->GetTimeSeconds();
+	ViolationScores[Index] = 0.0f;
+	CorrectionCounts[Index]++;
+
+	UE_LOG(LogTemp, Warning, TEXT("UMovementValidationSubsystem: corrected %s (%d in a row)"), *GetNameSafe(character), CorrectionCounts[Index]);
+
+	if (KickCorrectionCount > 0 && CorrectionCounts[Index] >= KickCorrectionCount)
+	{
+		APlayerController* playerController = Cast<APlayerController>(character->GetController());
+		AGameModeBase* gameMode = GetWorld()->GetAuthGameMode();
+		if (playerController && gameMode && gameMode->GameSession)
+		{
+			gameMode->GameSession->KickPlayer(playerController, FText::FromString(TEXT("Invalid movement")));
+		}
+	}
+}
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavArea_Climb.h"
+
+UNavArea_Climb::UNavArea_Climb(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	DrawColor = FColor::Orange;
+}
+
+void UNavArea_Climb::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// costs are read when the area is registered with the navigation system, after the config has been loaded
+	const float walkSpeed = FMath::Max(WalkSpeed, 1.0f);
+
+	DefaultCost = walkSpeed / FMath::Max(ClimbRate, 1.0f);
+	FixedAreaEnteringCost = ClimbOverTime * walkSpeed;
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SoundEventRegistry.h"
+
+void USoundEventRegistry::PostLoad()
+{
+	Super::PostLoad();
+
+	BuildIndex();
+}
+
+#if WITH_EDITOR
+void USoundEventRegistry::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	BuildIndex();
+}
+#endif
+
+void USoundEventRegistry::BuildIndex()
+{
+	IndexBySound.Reset();
+
+	const int32 numEvents = FMath::Min(Events.Num(), (int32)MAX_uint16 + 1);
+	if (numEvents < Events.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("USoundEventRegistry: %s has more events than a uint16 index can send, the rest are ignored"), *GetName());
+	}
+
+	for (int32 i = 0; i < numEvents; i++)
+	{
+		if (Events[i].Sound && !IndexBySound.Contains(Events[i].Sound))
+		{
+			IndexBySound.Add(Events[i].Sound, (uint16)i);
+		}
+	}
+}
+
+int32 USoundEventRegistry::FindEventIndex(const USoundBase* Sound) const
+{
+	const uint16* index = IndexBySound.Find(Sound);
+	return index ? *index : INDEX_NONE;
+}
@@ -2,14 +2,16 @@
 
 
 #include "SoundPlayerComponent.h"
-#include "Kismet/GameplayStatics.h"
 
 // Sets default values for this component's properties
 USoundPlayerComponent::USoundPlayerComponent()
 {
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
 	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = false;
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false; // only ticks to flush a frame's sound events
+
+	SetIsReplicatedByDefault(true);
 
 	// ...
 }
@@ -30,11 +32,87 @@ void USoundPlayerComponent::TickComponent(float DeltaTime, ELevelTick TickType,
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	// ...
+	FlushSoundEvents();
+	SetComponentTickEnabled(false);
+}
+
+void USoundPlayerComponent::PlaySoundAtPos(USoundBase* Sound, FVector WorldLoc, float VolumeMultiplier, float PitchMultiplierMin, float PitchMultiplierMax, float StartTime, ESoundCategory Category, float Priority)
+{
+#if !UE_SERVER
+	if (auto* audioManager = GetWorld()->GetSubsystem<UAudioManagerSubsystem>())
+	{
+		audioManager->PlaySoundAtLocation(Sound, WorldLoc, Category, VolumeMultiplier, FMath::RandRange(PitchMultiplierMin, PitchMultiplierMax), StartTime, Priority);
+	}
+#endif
+}
+
+void USoundPlayerComponent::PlaySoundEvent(USoundBase* Sound, FVector Location)
+{
+	AActor* owner = GetOwner();
+	if (!owner || !owner->HasAuthority() || owner->IsHidden() || !SoundEventRegistry)
+		return;
+
+	const int32 eventIndex = SoundEventRegistry->FindEventIndex(Sound);
+	if (eventIndex == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("USoundPlayerComponent: %s isn't in %s, sound event dropped"), *GetNameSafe(Sound), *SoundEventRegistry->GetName());
+		return;
+	}
+
+	if (PendingSoundEvents.Num() >= MaxSoundEventsPerFrame)
+		return;
+
+	FSoundNetEvent& soundEvent = PendingSoundEvents.AddDefaulted_GetRef();
+	soundEvent.EventIndex = (uint16)eventIndex;
+	soundEvent.Location = Location;
+	soundEvent.PitchSeed = (uint8)FMath::RandRange(0, MAX_uint8);
+	SetComponentTickEnabled(true);
+
+	// a listen server hears it now, a dedicated server never plays anything
+	PlaySoundEventLocal(soundEvent);
 }
 
-void USoundPlayerComponent::PlaySoundAtPos(USoundBase* Sound, FVector WorldLoc, float VolumeMultiplier, float PitchMultiplierMin, float PitchMultiplierMax, float StartTime)
+void USoundPlayerComponent::ResetForPool()
 {
-	UGameplayStatics::PlaySoundAtLocation(GetWorld(), Sound, WorldLoc, VolumeMultiplier, FMath::RandRange(PitchMultiplierMin, PitchMultiplierMax), StartTime);
+	PendingSoundEvents.Reset();
+	SetComponentTickEnabled(false);
 }
 
+void USoundPlayerComponent::FlushSoundEvents()
+{
+	if (PendingSoundEvents.Num() == 0)
+		return;
+
+	// standalone has nobody to send to
+	if (GetNetMode() != NM_Standalone)
+	{
+		MulticastSoundEvents(PendingSoundEvents);
+	}
+
+	PendingSoundEvents.Reset();
+}
+
+void USoundPlayerComponent::MulticastSoundEvents_Implementation(const TArray<FSoundNetEvent>& Events)
+{
+	// the server played them when they were queued
+	if (GetOwnerRole() == ROLE_Authority)
+		return;
+
+	for (const FSoundNetEvent& soundEvent : Events)
+	{
+		PlaySoundEventLocal(soundEvent);
+	}
+}
+
+void USoundPlayerComponent::PlaySoundEventLocal(const FSoundNetEvent& Event) const
+{
+#if !UE_SERVER
+	const FSoundEventDefinition* definition = SoundEventRegistry ? SoundEventRegistry->GetEvent(Event.EventIndex) : nullptr;
+	auto* audioManager = GetWorld()->GetSubsystem<UAudioManagerSubsystem>();
+	if (!definition || !audioManager)
+		return;
+
+	const float pitch = FMath::Lerp(definition->PitchMin, definition->PitchMax, Event.PitchSeed / 255.0f);
+	audioManager->PlaySoundAtLocation(definition->Sound, Event.Location, definition->Category, definition->Volume, pitch, 0.0f, definition->Priority);
+#endif
+}
@@ -4,6 +4,7 @@
 #include "StealthComponent.h"
 #include "ActionControlComponent.h"
 #include "KobWar/KobWarCharacter.h"
+#include "StealthPerceptionSubsystem.h"
 
 // Sets default values for this component's properties
 UStealthComponent::UStealthComponent()
@@ -12,7 +13,7 @@ UStealthComponent::UStealthComponent()
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = false;
 
-	// ...
+	SetIsReplicatedByDefault(true);
 }
 
 
@@ -71,13 +72,50 @@ void UStealthComponent::ToggleStealth(bool Activate)
 {
 	if (Owner && Owner->IsLocallyControlled())
 	{
+		ApplyStealth(Activate);
+
+		if (!Owner->HasAuthority())
+		{
+			ServerToggleStealth(Activate);
+		}
+	}
+}
+
+void UStealthComponent::ServerToggleStealth_Implementation(bool Activate)
+{
+	if (Owner && !Owner->IsInPawnPool())
+	{
+		ApplyStealth(Activate);
+	}
+}
+
+void UStealthComponent::ApplyStealth(bool Activate)
+{
+	Owner->SetStealthState(Activate);
+
+	if (IsStealthed != Activate)
+		OnStealthStateChange.Broadcast(Activate);
 
-		Owner->SetStealthState(Activate);
+	IsStealthed = Activate;
+}
+
+float UStealthComponent::GetLightLevel() const
+{
+	auto* stealthPerception = GetWorld()->GetSubsystem<UStealthPerceptionSubsystem>();
+	return stealthPerception && GetOwner() ? stealthPerception->GetLightLevel(GetOwner()->GetActorLocation()) : 1.0f;
+}
 
-		if (IsStealthed != Activate)
-			OnStealthStateChange.Broadcast(Activate);
+void UStealthComponent::ResetForPool()
+{
+	if (Owner)
+	{
+		Owner->SetStealthState(false);
+	}
 
-		IsStealthed = Activate;
+	if (IsStealthed)
+	{
+		IsStealthed = false;
+		OnStealthStateChange.Broadcast(false);
 	}
 }
 
@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "StealthLightGrid.h"
+#include "StealthPerceptionSubsystem.h"
+#include "Components/BoxComponent.h"
+#include "Components/DirectionalLightComponent.h"
+#include "Components/PointLightComponent.h"
+#include "Components/SpotLightComponent.h"
+#include "EngineUtils.h"
+
+AStealthLightGrid::AStealthLightGrid()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	BakeBounds = CreateDefaultSubobject<UBoxComponent>(TEXT("BakeBounds"));
+	BakeBounds->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BakeBounds->SetBoxExtent(FVector(5000.0f, 5000.0f, 1000.0f));
+	BakeBounds->SetHiddenInGame(true);
+	RootComponent = BakeBounds;
+}
+
+void AStealthLightGrid::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (auto* stealthPerception = GetWorld()->GetSubsystem<UStealthPerceptionSubsystem>())
+	{
+		stealthPerception->RegisterLightGrid(this);
+	}
+}
+
+void AStealthLightGrid::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (auto* stealthPerception = GetWorld()->GetSubsystem<UStealthPerceptionSubsystem>())
+	{
+		stealthPerception->UnregisterLightGrid(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AStealthLightGrid::BakeLightGrid()
+{
+	UWorld* world = GetWorld();
+	if (!world || CellSize <= 0.0f)
+		return;
+
+	// every shadow is a trace - without collision the whole grid would come out lit
+	if (!world->GetPhysicsScene())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AStealthLightGrid: %s has no physics scene to trace against, not baking"), *GetPathName());
+		return;
+	}
+
+	const FBox bounds = BakeBounds->Bounds.GetBox();
+	const FIntVector gridSize(
+		FMath::Max(FMath::CeilToInt(bounds.GetSize().X / CellSize), 1),
+		FMath::Max(FMath::CeilToInt(bounds.GetSize().Y / CellSize), 1),
+		FMath::Max(FMath::CeilToInt(bounds.GetSize().Z / CellSize), 1));
+
+	if ((int64)gridSize.X * gridSize.Y * gridSize.Z > MaxCells)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AStealthLightGrid: %d x %d x %d cells is over MaxCells, raise CellSize"), gridSize.X, gridSize.Y, gridSize.Z);
+		return;
+	}
+
+	// only lights baked into the level - movable lights come and go at runtime
+	TArray<ULightComponent*> lights;
+	for (TActorIterator<AActor> it(world); it; ++it)
+	{
+		TInlineComponentArray<ULightComponent*> actorLights(*it);
+		for (ULightComponent* light : actorLights)
+		{
+			if (light->IsVisible() && light->Mobility != EComponentMobility::Movable)
+			{
+				lights.Add(light);
+			}
+		}
+	}
+
+	GridOrigin = bounds.Min;
+	GridSize = gridSize;
+	LightLevels.SetNumUninitialized(gridSize.X * gridSize.Y * gridSize.Z);
+
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(LightGridBake), false);
+
+	for (int32 z = 0; z < gridSize.Z; z++)
+	{
+		for (int32 y = 0; y < gridSize.Y; y++)
+		{
+			for (int32 x = 0; x < gridSize.X; x++)
+			{
+				const FVector cellCenter = GridOrigin + (FVector(x, y, z) + 0.5f) * CellSize;
+				float level = AmbientLevel;
+
+				for (ULightComponent* light : lights)
+				{
+					queryParams.ClearIgnoredActors();
+					queryParams.AddIgnoredActor(light->GetOwner());
+
+					if (Cast<UDirectionalLightComponent>(light))
+					{
+						const FVector toLight = -light->GetDirection() * DirectionalTraceDistance;
+						if (!world->LineTraceTestByChannel(cellCenter, cellCenter + toLight, ECC_Visibility, queryParams))
+						{
+							level += DirectionalLevel;
+						}
+						continue;
+					}
+
+					UPointLightComponent* pointLight = Cast<UPointLightComponent>(light);
+					if (!pointLight)
+						continue;
+
+					const FVector lightPos = pointLight->GetComponentLocation();
+					const FVector toCell = cellCenter - lightPos;
+					const float dist = toCell.Size();
+					if (dist >= pointLight->AttenuationRadius)
+						continue;
+
+					if (USpotLightComponent* spotLight = Cast<USpotLightComponent>(pointLight))
+					{
+						const float cosOuter = FMath::Cos(FMath::DegreesToRadians(spotLight->OuterConeAngle));
+						if (dist > KINDA_SMALL_NUMBER && FVector::DotProduct(spotLight->GetDirection(), toCell / dist) < cosOuter)
+							continue;
+					}
+
+					if (world->LineTraceTestByChannel(lightPos, cellCenter, ECC_Visibility, queryParams))
+						continue;
+
+					const float falloff = FMath::Square(1.0f - dist / pointLight->AttenuationRadius);
+					level += pointLight->Intensity / FullBrightIntensity * falloff;
+				}
+
+				LightLevels[(z * gridSize.Y + y) * gridSize.X + x] = (uint8)FMath::RoundToInt(FMath::Clamp(level, 0.0f, 1.0f) * 255.0f);
+			}
+		}
+	}
+}
+
+bool AStealthLightGrid::SampleLightLevel(const FVector& Position, float& OutLevel) const
+{
+	if (LightLevels.Num() == 0)
+		return false;
+
+	// in cell units relative to the first cell center - the grid's faces are half a cell out from the edge centers
+	const FVector local = (Position - GridOrigin) / CellSize - 0.5f;
+	if (local.X < -0.5f || local.Y < -0.5f || local.Z < -0.5f || local.X > GridSize.X - 0.5f || local.Y > GridSize.Y - 0.5f || local.Z > GridSize.Z - 0.5f)
+		return false;
+
+	const int32 x0 = FMath::Clamp(FMath::FloorToInt(local.X), 0, GridSize.X - 1);
+	const int32 y0 = FMath::Clamp(FMath::FloorToInt(local.Y), 0, GridSize.Y - 1);
+	const int32 z0 = FMath::Clamp(FMath::FloorToInt(local.Z), 0, GridSize.Z - 1);
+	const int32 x1 = FMath::Min(x0 + 1, GridSize.X - 1);
+	const int32 y1 = FMath::Min(y0 + 1, GridSize.Y - 1);
+	const int32 z1 = FMath::Min(z0 + 1, GridSize.Z - 1);
+	const float fx = FMath::Clamp(local.X - x0, 0.0f, 1.0f);
+	const float fy = FMath::Clamp(local.Y - y0, 0.0f, 1.0f);
+	const float fz = FMath::Clamp(local.Z - z0, 0.0f, 1.0f);
+
+	const float bottom = FMath::Lerp(
+		FMath::Lerp((float)GetCell(x0, y0, z0), (float)GetCell(x1, y0, z0), fx),
+		FMath::Lerp((float)GetCell(x0, y1, z0), (float)GetCell(x1, y1, z0), fx), fy);
+	const float top = FMath::Lerp(
+		FMath::Lerp((float)GetCell(x0, y0, z1), (float)GetCell(x1, y0, z1), fx),
+		FMath::Lerp((float)GetCell(x0, y1, z1), (float)GetCell(x1, y1, z1), fx), fy);
+
+	OutLevel = FMath::Lerp(bottom, top, fz) / 255.0f;
+	return true;
+}
+
+#if WITH_EDITOR
+void AStealthLightGrid::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	// the button is the only bake - a cooking commandlet may not have the level's collision to trace against, so a cook
+	// just reports a grid that is missing or no longer matches its bounds
+	if (!TargetPlatform)
+		return;
+
+	const FBox bounds = BakeBounds->Bounds.GetBox();
+	const FIntVector expectedSize(
+		FMath::Max(FMath::CeilToInt(bounds.GetSize().X / CellSize), 1),
+		FMath::Max(FMath::CeilToInt(bounds.GetSize().Y / CellSize), 1),
+		FMath::Max(FMath::CeilToInt(bounds.GetSize().Z / CellSize), 1));
+
+	if (GridSize != expectedSize || LightLevels.Num() != GridSize.X * GridSize.Y * GridSize.Z || !GridOrigin.Equals(bounds.Min, 1.0f))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AStealthLightGrid: %s is cooked with a stale or missing bake, run Bake Light Grid in the editor and save"), *GetPathName());
+	}
+}
+#endif
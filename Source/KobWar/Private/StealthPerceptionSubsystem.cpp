@@ -0,0 +1,325 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "StealthPerceptionSubsystem.h"
+#include "StealthLightGrid.h"
+#include "VisibilitySubsystem.h"
+#include "KobWar/KobWarCharacter.h"
+
+bool UStealthPerceptionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* world = Cast<UWorld>(Outer);
+	return world && world->IsGameWorld();
+}
+
+void UStealthPerceptionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	VisibilitySubsystem = Cast<UVisibilitySubsystem>(Collection.InitializeDependency(UVisibilitySubsystem::StaticClass()));
+}
+
+void UStealthPerceptionSubsystem::Deinitialize()
+{
+	Characters.Empty();
+	Ids.Empty();
+	Positions.Empty();
+	EyePositions.Empty();
+	ViewDirections.Empty();
+	Speeds.Empty();
+	Teams.Empty();
+	IsStealthed.Empty();
+	StealthStartTimes.Empty();
+	IsObserving.Empty();
+	IdsByActor.Empty();
+	Grid.Empty();
+	Pairs.Empty();
+	VisibilitySubsystem = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UStealthPerceptionSubsystem::IsTickable() const
+{
+	UWorld* world = GetWorld();
+	if (!world || Characters.Num() == 0)
+		return false;
+
+	// clients have no say in who noticed whom
+	return world->GetNetMode() != NM_Client;
+}
+
+TStatId UStealthPerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStealthPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UStealthPerceptionSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+void UStealthPerceptionSubsystem::RegisterCharacter(AKobWarCharacter* Character)
+{
+	if (!Character || IdsByActor.Contains(Character))
+		return;
+
+	const uint32 id = NextId++;
+
+	Characters.Add(Character);
+	Ids.Add(id);
+	Positions.Add(Character->GetActorLocation());
+	EyePositions.Add(Character->GetPawnViewLocation());
+	ViewDirections.Add(Character->GetActorForwardVector());
+	Speeds.Add(0.0f);
+	Teams.Add(Character->GenericTeamId);
+	IsStealthed.Add(false);
+	StealthStartTimes.Add(-1.0f);
+	IsObserving.Add(!Character->IsInPawnPool());
+	IdsByActor.Add(Character, id);
+}
+
+void UStealthPerceptionSubsystem::UnregisterCharacter(AKobWarCharacter* Character)
+{
+	const int32 index = Characters.IndexOfByKey(Character);
+	if (index != INDEX_NONE)
+	{
+		RemoveAtSwap(index);
+	}
+}
+
+void UStealthPerceptionSubsystem::RemoveAtSwap(int32 Index)
+{
+	// pairs of the removed id age out through PrunePairs
+	IdsByActor.Remove(Characters[Index]);
+
+	Characters.RemoveAtSwap(Index, 1, false);
+	Ids.RemoveAtSwap(Index, 1, false);
+	Positions.RemoveAtSwap(Index, 1, false);
+	EyePositions.RemoveAtSwap(Index, 1, false);
+	ViewDirections.RemoveAtSwap(Index, 1, false);
+	Speeds.RemoveAtSwap(Index, 1, false);
+	Teams.RemoveAtSwap(Index, 1, false);
+	IsStealthed.RemoveAtSwap(Index, 1, false);
+	StealthStartTimes.RemoveAtSwap(Index, 1, false);
+	IsObserving.RemoveAtSwap(Index, 1, false);
+}
+
+void UStealthPerceptionSubsystem::GatherCharacterData(const float Now)
+{
+	NumStealthed = 0;
+
+	for (int32 i = Characters.Num() - 1; i >= 0; i--)
+	{
+		AKobWarCharacter* character = Characters[i].Get();
+		if (!character)
+		{
+			RemoveAtSwap(i);
+			continue;
+		}
+
+		Positions[i] = character->GetActorLocation();
+		EyePositions[i] = character->GetPawnViewLocation();
+		ViewDirections[i] = character->GetBaseAimRotation().Vector();
+		Speeds[i] = character->GetVelocity().Size();
+		Teams[i] = character->GenericTeamId;
+		IsObserving[i] = !character->IsInPawnPool();
+
+		const bool stealthed = character->IsStealthed && IsObserving[i];
+		if (stealthed && !IsStealthed[i])
+		{
+			StealthStartTimes[i] = Now;
+		}
+		IsStealthed[i] = stealthed;
+
+		NumStealthed += IsStealthed[i] ? 1 : 0;
+	}
+}
+
+FIntPoint UStealthPerceptionSubsystem::GetCell(const FVector& Position) const
+{
+	return FIntPoint(FMath::FloorToInt(Position.X / PerceptionRange), FMath::FloorToInt(Position.Y / PerceptionRange));
+}
+
+void UStealthPerceptionSubsystem::BuildGrid()
+{
+	// keeps the cell arrays allocated between frames
+	for (auto& cell : Grid)
+	{
+		cell.Value.Reset();
+	}
+
+	for (int32 i = 0; i < Characters.Num(); i++)
+	{
+		if (IsStealthed[i])
+		{
+			Grid.FindOrAdd(GetCell(Positions[i])).Add(i);
+		}
+	}
+}
+
+void UStealthPerceptionSubsystem::Tick(float DeltaTime)
+{
+	const float now = GetWorld()->GetTimeSeconds();
+
+	GatherCharacterData(now);
+
+	if (NumStealthed > 0)
+	{
+		BuildGrid();
+
+		const int32 evaluateCount = FMath::Min(ObserversPerFrame, Characters.Num());
+		for (int32 i = 0; i < evaluateCount; i++)
+		{
+			if (ObserverCursor >= Characters.Num())
+			{
+				ObserverCursor = 0;
+			}
+
+			EvaluateObserver(ObserverCursor++, now);
+		}
+	}
+
+	PrunePairs(now);
+}
+
+void UStealthPerceptionSubsystem::EvaluateObserver(const int32 ObserverIndex, const float Now)
+{
+	if (!IsObserving[ObserverIndex])
+		return;
+
+	const FVector observerPos = Positions[ObserverIndex];
+	const FVector viewDir = ViewDirections[ObserverIndex];
+	const uint8 observerTeam = Teams[ObserverIndex];
+	const FIntPoint observerCell = GetCell(observerPos);
+	const float rangeSq = FMath::Square(PerceptionRange);
+
+	for (int32 y = -1; y <= 1; y++)
+	{
+		for (int32 x = -1; x <= 1; x++)
+		{
+			const auto* cellTargets = Grid.Find(observerCell + FIntPoint(x, y));
+			if (!cellTargets)
+				continue;
+
+			for (const int32 target : *cellTargets)
+			{
+				if (target == ObserverIndex || Teams[target] == observerTeam)
+					continue;
+
+				const FVector toTarget = Positions[target] - observerPos;
+				const float distSq = toTarget.SizeSquared();
+				if (distSq > rangeSq)
+					continue;
+
+				const float dist = FMath::Sqrt(distSq);
+				const float facing = dist > KINDA_SMALL_NUMBER ? FVector::DotProduct(viewDir, toTarget / dist) : 1.0f;
+
+				const float distanceFactor = 1.0f - dist / PerceptionRange;
+				const float speedFactor = FMath::Lerp(StillFactor, 1.0f, FMath::Min(Speeds[target] / MovingSpeed, 1.0f));
+				const float facingFactor = FMath::Lerp(RearFactor, 1.0f, facing * 0.5f + 0.5f);
+				const float lightFactor = FMath::Lerp(DarkFactor, 1.0f, GetLightLevel(Positions[target]));
+
+				const uint64 pairKey = MakePairKey(Ids[ObserverIndex], Ids[target]);
+				FStealthPairState& pair = Pairs.FindOrAdd(pairKey);
+
+				// a target that just stealthed where this observer could see it stays noticed, anything else starts
+				// unnoticed and accumulates from the pair's next evaluation
+				if (pair.LastEvalTime < 0.0f && Now - StealthStartTimes[target] <= StealthSeedTime && VisibilitySubsystem
+					&& VisibilitySubsystem->TestVisibility(Characters[ObserverIndex].Get(), Characters[target].Get(), EyePositions[ObserverIndex], Positions[target]))
+				{
+					pair.Detection = 1.0f;
+					pair.Visible = true;
+				}
+
+				const float elapsed = pair.LastEvalTime >= 0.0f ? FMath::Min(Now - pair.LastEvalTime, PairTimeout) : 0.0f;
+
+				// the answer lands on the pair for its next evaluation - straight away when the service has it cached
+				if (VisibilitySubsystem)
+				{
+					VisibilitySubsystem->RequestVisibility(Characters[ObserverIndex].Get(), Characters[target].Get(), EyePositions[ObserverIndex], Positions[target],
+						FVisibilityResult::CreateUObject(this, &UStealthPerceptionSubsystem::OnVisibilityResult, pairKey));
+				}
+
+				const float exposure = pair.Visible ? distanceFactor * speedFactor * facingFactor * lightFactor : 0.0f;
+
+				pair.Detection = FMath::Clamp(pair.Detection + (exposure * GainPerSecond - DecayPerSecond) * elapsed, 0.0f, 1.0f);
+				pair.LastEvalTime = Now;
+			}
+		}
+	}
+}
+
+void UStealthPerceptionSubsystem::OnVisibilityResult(bool Visible, uint64 PairKey)
+{
+	// the pair may have been pruned while the trace was in flight
+	if (FStealthPairState* pair = Pairs.Find(PairKey))
+	{
+		pair->Visible = Visible;
+	}
+}
+
+void UStealthPerceptionSubsystem::PrunePairs(const float Now)
+{
+	for (auto it = Pairs.CreateIterator(); it; ++it)
+	{
+		if (Now - it.Value().LastEvalTime > PairTimeout)
+		{
+			it.RemoveCurrent();
+		}
+	}
+}
+
+void UStealthPerceptionSubsystem::RegisterLightGrid(AStealthLightGrid* Grid)
+{
+	if (LightGrid.IsValid() && LightGrid.Get() != Grid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UStealthPerceptionSubsystem: %s replaces light grid %s, only one is used per level"), *GetNameSafe(Grid), *GetNameSafe(LightGrid.Get()));
+	}
+
+	LightGrid = Grid;
+}
+
+void UStealthPerceptionSubsystem::UnregisterLightGrid(AStealthLightGrid* Grid)
+{
+	if (LightGrid.Get() == Grid)
+	{
+		LightGrid.Reset();
+	}
+}
+
+float UStealthPerceptionSubsystem::GetLightLevel(const FVector& Position) const
+{
+	float level;
+	if (const AStealthLightGrid* grid = LightGrid.Get())
+	{
+		if (grid->SampleLightLevel(Position, level))
+			return level;
+	}
+
+	return DefaultLightLevel;
+}
+
+float UStealthPerceptionSubsystem::GetDetection(const AActor* Observer, const AActor* Target) const
+{
+	const AKobWarCharacter* targetCharacter = Cast<AKobWarCharacter>(Target);
+	const AKobWarCharacter* observerCharacter = Cast<AKobWarCharacter>(Observer);
+	if (!targetCharacter || !observerCharacter || !targetCharacter->IsStealthed || observerCharacter == targetCharacter)
+		return 1.0f;
+
+	if (observerCharacter->GenericTeamId == targetCharacter->GenericTeamId || GetWorld()->GetNetMode() == NM_Client)
+		return 1.0f;
+
+	const uint32* observerId = IdsByActor.Find(observerCharacter);
+	const uint32* targetId = IdsByActor.Find(targetCharacter);
+	if (!observerId || !targetId)
+		return 0.0f;
+
+	const FStealthPairState* pair = Pairs.Find(MakePairKey(*observerId, *targetId));
+	return pair ? pair->Detection : 0.0f;
+}
+
+bool UStealthPerceptionSubsystem::IsDetected(const AActor* Observer, const AActor* Target) const
+{
+	return GetDetection(Observer, Target) >= DetectedThreshold;
+}
@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GameFramework/PlayerController.h"
+#include "KobWar/KobWarGameMode.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/* Native team registry rules on a bare AKobWarGameMode - no world, no Blueprint. The controllers are only registry keys */
+struct FTeamRegistryTestSetup
+{
+	AKobWarGameMode* GameMode = nullptr;
+
+	TArray<APlayerController*> Players;
+
+	FTeamRegistryTestSetup(const int32 NumPlayers)
+	{
+		GameMode = NewObject<AKobWarGameMode>(GetTransientPackage(), NAME_None, RF_Transient);
+		GameMode->IsTeamBased = true;
+		GameMode->TeamRatio = 0.5f;
+		GameMode->MaxAmountPlayersPerTeam = 8;
+		GameMode->MaxSpectators = 2;
+		GameMode->AllowTeamSwitching = true;
+		GameMode->AllowInbalancedTeamSwitching = true;
+
+		for (int32 i = 0; i < NumPlayers; i++)
+		{
+			Players.Add(NewObject<APlayerController>(GetTransientPackage(), NAME_None, RF_Transient));
+		}
+	}
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTeamRegistryTest, "KobWar.GameMode.TeamRegistry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTeamRegistryTest::RunTest(const FString& Parameters)
+{
+	// per-team cap and an even ratio
+	{
+		FTeamRegistryTestSetup setup(5);
+		AKobWarGameMode* gameMode = setup.GameMode;
+		TArray<APlayerController*>& players = setup.Players;
+		gameMode->MaxAmountPlayersPerTeam = 2;
+
+		TestTrue(TEXT("First player can always join"), gameMode->AssignPlayerTeam(players[0], ETeam::Team_1, false));
+		TestFalse(TEXT("Second player can't stack the same team at 0.5"), gameMode->AssignPlayerTeam(players[1], ETeam::Team_1, false));
+		TestTrue(TEXT("Second player joins the other team"), gameMode->AssignPlayerTeam(players[1], ETeam::Team_2, false));
+		TestTrue(TEXT("Third player rounds up into Team_1"), gameMode->AssignPlayerTeam(players[2], ETeam::Team_1, false));
+		TestFalse(TEXT("Team_1 is at MaxAmountPlayersPerTeam"), gameMode->CanJoinTeam(players[3], ETeam::Team_1));
+		TestTrue(TEXT("Fourth player joins Team_2"), gameMode->AssignPlayerTeam(players[3], ETeam::Team_2, false));
+		TestFalse(TEXT("Both teams full - Team_1"), gameMode->CanJoinTeam(players[4], ETeam::Team_1));
+		TestFalse(TEXT("Both teams full - Team_2"), gameMode->CanJoinTeam(players[4], ETeam::Team_2));
+		TestEqual(TEXT("Both teams full - balancer picks spectating"), (int32)gameMode->PickBalancedTeam(), (int32)ETeam::Spectating);
+		TestTrue(TEXT("ForceSwitch ignores the cap"), gameMode->AssignPlayerTeam(players[4], ETeam::Team_1, true));
+		TestEqual(TEXT("Team_1 count"), gameMode->GetTeamCount(ETeam::Team_1), 3);
+		TestEqual(TEXT("Team_2 count"), gameMode->GetTeamCount(ETeam::Team_2), 2);
+
+		uint8 team;
+		TestTrue(TEXT("Registered player has a team"), gameMode->GetPlayerTeam(players[3], team));
+		TestEqual(TEXT("Registered player's team"), (int32)team, (int32)ETeam::Team_2);
+
+		gameMode->RemovePlayerFromTeams(players[3]);
+		TestFalse(TEXT("Removed player has no team"), gameMode->GetPlayerTeam(players[3], team));
+		TestEqual(TEXT("Team_2 count after removal"), gameMode->GetTeamCount(ETeam::Team_2), 1);
+	}
+
+	// spectator cap
+	{
+		FTeamRegistryTestSetup setup(2);
+		setup.GameMode->MaxSpectators = 1;
+
+		TestTrue(TEXT("First spectator"), setup.GameMode->AssignPlayerTeam(setup.Players[0], ETeam::Spectating, false));
+		TestFalse(TEXT("Over MaxSpectators"), setup.GameMode->AssignPlayerTeam(setup.Players[1], ETeam::Spectating, false));
+	}
+
+	// switching rules
+	{
+		FTeamRegistryTestSetup setup(3);
+		AKobWarGameMode* gameMode = setup.GameMode;
+		TArray<APlayerController*>& players = setup.Players;
+		gameMode->AssignPlayerTeam(players[0], ETeam::Team_1, true);
+		gameMode->AssignPlayerTeam(players[1], ETeam::Team_1, true);
+		gameMode->AssignPlayerTeam(players[2], ETeam::Team_2, true);
+
+		gameMode->AllowInbalancedTeamSwitching = false;
+		TestFalse(TEXT("Switch that breaks the ratio"), gameMode->CanJoinTeam(players[2], ETeam::Team_1));
+		TestTrue(TEXT("Switch that evens the teams"), gameMode->CanJoinTeam(players[0], ETeam::Team_2));
+
+		gameMode->AllowInbalancedTeamSwitching = true;
+		TestTrue(TEXT("Imbalanced switch allowed"), gameMode->CanJoinTeam(players[2], ETeam::Team_1));
+
+		gameMode->AllowTeamSwitching = false;
+		TestFalse(TEXT("Switching disabled"), gameMode->CanJoinTeam(players[0], ETeam::Team_2));
+		TestTrue(TEXT("ForceSwitch with switching disabled"), gameMode->AssignPlayerTeam(players[0], ETeam::Team_2, true));
+		TestEqual(TEXT("Team_1 count after forced switch"), gameMode->GetTeamCount(ETeam::Team_1), 1);
+		TestEqual(TEXT("Team_2 count after forced switch"), gameMode->GetTeamCount(ETeam::Team_2), 2);
+	}
+
+	// uneven ratio filled through the balancer
+	{
+		FTeamRegistryTestSetup setup(4);
+		AKobWarGameMode* gameMode = setup.GameMode;
+		gameMode->TeamRatio = 0.25f;
+
+		for (APlayerController* player : setup.Players)
+		{
+			TestTrue(TEXT("Balancer's pick is accepted"), gameMode->AssignPlayerTeam(player, gameMode->PickBalancedTeam(), false));
+		}
+
+		TestEqual(TEXT("Team_1 holds 25%"), gameMode->GetTeamCount(ETeam::Team_1), 1);
+		TestEqual(TEXT("Team_2 holds 75%"), gameMode->GetTeamCount(ETeam::Team_2), 3);
+	}
+
+	// sides, not members
+	{
+		FTeamRegistryTestSetup setup(2);
+		AKobWarGameMode* gameMode = setup.GameMode;
+		gameMode->AssignPlayerTeam(setup.Players[0], ETeam::Team_1, false);
+		gameMode->AssignPlayerTeam(setup.Players[1], ETeam::Team_2, false);
+		const bool wasBlackAttacking = gameMode->IsBlackTeamAttacking;
+
+		gameMode->SwitchAttackingSides();
+
+		uint8 team;
+		gameMode->GetPlayerTeam(setup.Players[0], team);
+		TestEqual(TEXT("Switching sides keeps team membership"), (int32)team, (int32)ETeam::Team_1);
+		TestTrue(TEXT("Switching sides swaps the attacker"), gameMode->IsBlackTeamAttacking != wasBlackAttacking);
+	}
+
+	// teams set by Blueprint logic that only broadcasts
+	{
+		FTeamRegistryTestSetup setup(3);
+		AKobWarGameMode* gameMode = setup.GameMode;
+		TArray<APlayerController*>& players = setup.Players;
+		gameMode->OnPlayerSetToTeam.Broadcast(players[0], ETeam::Team_1);
+		gameMode->OnPlayerSetToTeam.Broadcast(players[1], ETeam::Team_1);
+		gameMode->OnPlayerSetToTeam.Broadcast(players[2], ETeam::Team_2);
+
+		TestEqual(TEXT("Broadcast Team_1 count"), gameMode->GetTeamCount(ETeam::Team_1), 2);
+		TestEqual(TEXT("Broadcast Team_2 count"), gameMode->GetTeamCount(ETeam::Team_2), 1);
+
+		gameMode->OnPlayerSetToTeam.Broadcast(players[1], ETeam::Team_2);
+		TestEqual(TEXT("Broadcast switch leaves Team_1"), gameMode->GetTeamCount(ETeam::Team_1), 1);
+		TestEqual(TEXT("Broadcast switch joins Team_2"), gameMode->GetTeamCount(ETeam::Team_2), 2);
+	}
+
+	// free for all
+	{
+		FTeamRegistryTestSetup setup(1);
+		setup.GameMode->IsTeamBased = false;
+
+		TestFalse(TEXT("No playing teams without IsTeamBased"), setup.GameMode->CanJoinTeam(setup.Players[0], ETeam::Team_1));
+		TestTrue(TEXT("Neutral without IsTeamBased"), setup.GameMode->CanJoinTeam(setup.Players[0], ETeam::NeutralTeam));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VisibilitySubsystem.h"
+#include "KobWarQuerySubsystem.h"
+
+bool UVisibilitySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* world = Cast<UWorld>(Outer);
+	return world && world->IsGameWorld();
+}
+
+void UVisibilitySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	QuerySubsystem = Cast<UKobWarQuerySubsystem>(Collection.InitializeDependency(UKobWarQuerySubsystem::StaticClass()));
+}
+
+void UVisibilitySubsystem::Deinitialize()
+{
+	PendingRequests.Empty();
+	InFlightRequests.Empty();
+	VisibilityCache.Empty();
+	QuerySubsystem = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UVisibilitySubsystem::IsTickable() const
+{
+	return (PendingRequests.Num() > 0 || VisibilityCache.Num() > 0) && GetWorld();
+}
+
+TStatId UVisibilitySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UVisibilitySubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UVisibilitySubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+void UVisibilitySubsystem::RequestVisibility(AActor* Observer, AActor* Target, const FVector& Start, const FVector& End, FVisibilityResult Callback)
+{
+	bool cachedVisible;
+	if (GetCachedVisibility(Observer, Target, Start, End, cachedVisible))
+	{
+		Callback.ExecuteIfBound(cachedVisible);
+		return;
+	}
+
+	auto isSamePair = [Observer, Target](const FVisibilityRequest& Request)
+	{
+		return Request.Observer.Get() == Observer && Request.Target.Get() == Target;
+	};
+
+	// the same pair is already on its way - piggyback on that trace
+	for (auto& inFlight : InFlightRequests)
+	{
+		if (isSamePair(inFlight.Value))
+		{
+			inFlight.Value.Callbacks.Add(MoveTemp(Callback));
+			return;
+		}
+	}
+
+	if (FVisibilityRequest* pending = PendingRequests.FindByPredicate(isSamePair))
+	{
+		pending->Start = Start;
+		pending->End = End;
+		pending->Callbacks.Add(MoveTemp(Callback));
+		return;
+	}
+
+	FVisibilityRequest& request = PendingRequests.AddDefaulted_GetRef();
+	request.Observer = Observer;
+	request.Target = Target;
+	request.Start = Start;
+	request.End = End;
+	request.Callbacks.Add(MoveTemp(Callback));
+}
+
+bool UVisibilitySubsystem::TestVisibility(AActor* Observer, AActor* Target, const FVector& Start, const FVector& End)
+{
+	bool visible;
+	if (GetCachedVisibility(Observer, Target, Start, End, visible))
+		return visible;
+
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(VisibilityService), false, Observer);
+	queryParams.AddIgnoredActor(Target);
+
+	TracesIssued++;
+	visible = !GetWorld()->LineTraceTestByChannel(Start, End, ECC_Visibility, queryParams);
+	StoreVisibility(Observer, Target, Start, End, visible);
+	return visible;
+}
+
+bool UVisibilitySubsystem::GetCachedVisibility(AActor* Observer, AActor* Target, const FVector& Start, const FVector& End, bool& OutVisible) const
+{
+	const FVisibilityCacheEntry* entry = VisibilityCache.Find(TPair<TWeakObjectPtr<AActor>, TWeakObjectPtr<AActor>>(Observer, Target));
+	if (!entry || GFrameCounter - entry->Frame > (uint64)CacheValidFrames)
+		return false;
+
+	const float moveThresholdSq = FMath::Square(CacheMoveThreshold);
+	if (FVector::DistSquared(entry->Start, Start) > moveThresholdSq || FVector::DistSquared(entry->End, End) > moveThresholdSq)
+		return false;
+
+	OutVisible = entry->Visible;
+	return true;
+}
+
+void UVisibilitySubsystem::StoreVisibility(AActor* Observer, AActor* Target, const FVector& Start, const FVector& End, const bool Visible)
+{
+	FVisibilityCacheEntry& entry = VisibilityCache.FindOrAdd(TPair<TWeakObjectPtr<AActor>, TWeakObjectPtr<AActor>>(Observer, Target));
+	entry.Start = Start;
+	entry.End = End;
+	entry.Frame = GFrameCounter;
+	entry.Visible = Visible;
+}
+
+void UVisibilitySubsystem::PruneCache()
+{
+	for (auto it = VisibilityCache.CreateIterator(); it; ++it)
+	{
+		if (GFrameCounter - it.Value().Frame > (uint64)CacheValidFrames || !it.Key().Key.IsValid() || !it.Key().Value.IsValid())
+		{
+			it.RemoveCurrent();
+		}
+	}
+}
+
+void UVisibilitySubsystem::Tick(float DeltaTime)
+{
+	PruneCache();
+
+	const int32 issueCount = FMath::Min(PendingRequests.Num(), MaxTracesPerFrame);
+
+	for (int32 i = 0; i < issueCount; i++)
+	{
+		IssueTrace(MoveTemp(PendingRequests[i]));
+	}
+
+	// oldest first, whatever is over budget waits for the next frame
+	PendingRequests.RemoveAt(0, issueCount, false);
+}
+
+void UVisibilitySubsystem::IssueTrace(FVisibilityRequest&& Request)
+{
+	AActor* observer = Request.Observer.Get();
+	AActor* target = Request.Target.Get();
+	if (!observer || !target || !QuerySubsystem)
+		return;
+
+	FKobWarQueryRequest query;
+	query.Start = Request.Start;
+	query.End = Request.End;
+	query.IgnoreActor = observer;
+	query.IgnoreActor2 = target;
+
+	Request.RequestId = NextRequestId++;
+	TracesIssued++;
+	QuerySubsystem->RequestTrace(query, FKobWarQueryDone::CreateUObject(this, &UVisibilitySubsystem::OnTraceCompleted, Request.RequestId));
+
+	InFlightRequests.Add(Request.RequestId, MoveTemp(Request));
+}
+
+void UVisibilitySubsystem::OnTraceCompleted(const FKobWarQueryResult& Result, uint32 RequestId)
+{
+	FVisibilityRequest request;
+	if (!InFlightRequests.RemoveAndCopyValue(RequestId, request))
+		return;
+
+	const bool visible = !Result.IsHit;
+	StoreVisibility(request.Observer.Get(), request.Target.Get(), request.Start, request.End, visible);
+
+	for (FVisibilityResult& callback : request.Callbacks)
+	{
+		callback.ExecuteIfBound(visible);
+	}
+}
@@ -244,6 +244,9 @@ public:
 
 	FName GetCurrentAction();
 
+	/* Clears all action timers, queued actions and held/charging state so a pooled character starts fresh */
+	void ResetForPool();
+
 #pragma region Queue or Activate Actions
 
 	bool ActivateOrQueueAction(EQueueActions Action);
@@ -326,10 +329,20 @@ public:
 
 	void SetIsClimbing(bool Toggle);	// Update when the character is climbing
 
+	void SetClimbingMesh(class AClimbingMesh* ClimbingMesh);	// Mesh being climbed - its baked data replaces the climb traces
+
 	bool TraceCheckIfClimbingAtTop();
 
 	bool TraceForFloorBelow();
 
+	void GetClimbTopTrace(FVector& OutStart, FVector& OutEnd) const;
+
+	void GetFloorBelowTrace(FVector& OutStart, FVector& OutEnd) const;
+
+	void RequestClimbTraces();	// Queues the unbaked climb checks in the query batch so the next climb input finds their answers
+
+	bool TraceClimbCheck(FName Tag, const FVector& Start, const FVector& End);	// Last batched answer traced from Start, or a synchronous trace
+
 
 public:
 
@@ -448,9 +461,20 @@ protected:
 
 	bool IsClimbing = false;
 
+	UPROPERTY()
+	class AClimbingMesh* CurrentClimbingMesh = nullptr;
+
+	/* A batched climb check answer is used while the climber is within this distance of where it was traced */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Actions")
+	float ClimbTraceTolerance = 10.0f;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Actions")
 	float AimingMovementSpeed = 50.0f;
 
+	/* Draws the climb-top and floor traces. Compiled out of dedicated servers. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Debug")
+	bool DebugTrace = false;
+
 	FName CurrentAction = FName("?");
 
 	public:
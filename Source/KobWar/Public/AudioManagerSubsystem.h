@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "AudioManagerSubsystem.generated.h"
+
+class UAudioComponent;
+class USoundBase;
+
+/* Voice budget each sound plays under */
+UENUM(BlueprintType)
+enum class ESoundCategory : uint8
+{
+	Footstep,
+	Combat,
+	Voice,
+	World,
+	MAX UMETA(Hidden)
+};
+
+/* A sound asked for this frame, waiting to be culled or played */
+struct FPendingSound
+{
+	USoundBase* Sound = nullptr;
+
+	FVector Location = FVector::ZeroVector;
+
+	float Volume = 1.0f;
+
+	float Pitch = 1.0f;
+
+	float StartTime = 0.0f;
+
+	float Priority = 1.0f;
+
+	float Score = 0.0f;
+
+	ESoundCategory Category = ESoundCategory::World;
+};
+
+/**
+ * Plays one-shot world sounds through a pool of audio components. Requests are collected over the frame and
+ * resolved together in Tick: duplicates of the same sound close to each other are merged, sounds out of the
+ * listener's range are culled, and the rest play loudest and most important first until their category's voice
+ * budget is used up. Nothing reaches the audio engine for a sound that was dropped. Not created on dedicated servers.
+ */
+UCLASS(config = Game)
+class KOBWAR_API UAudioManagerSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Deinitialize() override;
+
+#pragma region Tickable
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+#pragma endregion
+
+	/* Queues a one-shot sound for the end of the frame. Priority scales how it competes for its category's voices */
+	void PlaySoundAtLocation(USoundBase* Sound, const FVector& Location, ESoundCategory Category, float Volume = 1.0f, float Pitch = 1.0f, float StartTime = 0.0f, float Priority = 1.0f);
+
+	int32 GetActiveVoices(ESoundCategory Category) const { return ActiveVoices[(uint8)Category]; }
+
+protected:
+
+	int32 GetVoiceBudget(ESoundCategory Category) const;
+
+	bool GetListenerLocation(FVector& OutLocation) const;
+
+	/* Index of a free pooled component, creating one when every component is playing */
+	int32 AcquireAudioComponent();
+
+	void OnAudioFinished(UAudioComponent* AudioComponent);
+
+protected:
+
+#pragma region Tuning
+
+	UPROPERTY(Config)
+	int32 MaxFootstepVoices = 8;
+
+	UPROPERTY(Config)
+	int32 MaxCombatVoices = 12;
+
+	UPROPERTY(Config)
+	int32 MaxVoiceVoices = 4;
+
+	UPROPERTY(Config)
+	int32 MaxWorldVoices = 8;
+
+	// Same sound requested again within this distance in one frame plays once
+	UPROPERTY(Config)
+	float DuplicateDistance = 100.0f;
+
+	// Used for sounds without attenuation, which would otherwise be heard everywhere
+	UPROPERTY(Config)
+	float DefaultMaxDistance = 4000.0f;
+
+#pragma endregion
+
+	TArray<FPendingSound> PendingSounds;
+
+	UPROPERTY()
+	TArray<UAudioComponent*> AudioPool;
+
+	// index-aligned with AudioPool
+	TArray<ESoundCategory> PoolCategories;
+
+	TArray<bool> PoolInUse;
+
+	int32 ActiveVoices[(uint8)ESoundCategory::MAX] = {};
+
+};
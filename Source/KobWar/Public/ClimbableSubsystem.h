@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ClimbableSubsystem.generated.h"
+
+class AClimbingMesh;
+
+/**
+ * Registry of climbable meshes. Each AClimbingMesh registers its world bounds and climb anchor on BeginPlay, bucketed
+ * in a 2D grid of CellSize cells, so checking for something to climb is a lookup of the cells a box overlaps instead
+ * of a physics sweep against everything visible.
+ */
+UCLASS(config = Game)
+class KOBWAR_API UClimbableSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	void RegisterClimbingMesh(AClimbingMesh* ClimbingMesh);
+
+	void UnregisterClimbingMesh(AClimbingMesh* ClimbingMesh);
+
+	/* Registered climbing mesh whose bounds overlap QueryBox, the one with the nearest climb anchor when several do */
+	AClimbingMesh* FindClimbingMesh(const FBox& QueryBox) const;
+
+	bool IsRegistered(const AClimbingMesh* ClimbingMesh) const { return ClimbingMeshes.Contains(ClimbingMesh); }
+
+protected:
+
+	void AddToCells(const int32 Index);
+
+	void RemoveFromCells(const int32 Index);
+
+	void ReplaceInCells(const int32 OldIndex, const int32 NewIndex);
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+protected:
+
+	UPROPERTY(Config)
+	float CellSize = 500.0f;
+
+	UPROPERTY()
+	TArray<AClimbingMesh*> ClimbingMeshes;
+
+	TArray<FBox> ClimbBounds;
+
+	TArray<FVector> ClimbAnchors;
+
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+};
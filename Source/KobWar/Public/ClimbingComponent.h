@@ -22,6 +22,19 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FClimbStateChange, TEnumAsByte<Climb
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMovementModeChange, TEnumAsByte<EMovementMode>, MovementMode);
 
+/* Climb state seen by other players - the mesh goes over the wire as a net GUID, progress is 0-255 from bottom to top */
+USTRUCT()
+struct FClimbReplicationStruct
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	AClimbingMesh* ClimbMesh = nullptr;
+
+	UPROPERTY()
+	uint8 Progress = 0;
+};
+
 
 UCLASS(BlueprintType, Blueprintable)
 class KOBWAR_API UClimbingComponent : public UActorComponent
@@ -32,14 +45,12 @@ public:
 	// Sets default values for this component's properties
 	UClimbingComponent();
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
-public:
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
-
 protected:
 
 	void InitOwner();
@@ -76,8 +87,6 @@ public:
 
 	void EndClimbInputTimer();
 
-	void InterpToClimbingMesh(float DeltaTime);
-
 	UFUNCTION(BlueprintImplementableEvent)
 	void UpdateAnimationClimbingState(bool IsClimbing);
 
@@ -93,8 +102,80 @@ public:
 
 	void ClimbEnd();
 
+	/* Async - moves the owner onto the floor below once the trace comes back */
 	void SnapOwnerToSurface();
 
+	void OnSurfaceTraceDone(const struct FKobWarQueryResult& Result);
+
+	/* Ends any climb and clears the climb timers so a pooled character starts on the ground */
+	void ResetForPool();
+
+#pragma endregion
+
+#pragma region Navigation
+
+public:
+
+	/* Starts a climb for a bot that reached ClimbableMesh's nav link and keeps climbing up until it is over the top */
+	bool BeginNavLinkClimb(AClimbingMesh* ClimbableMesh, class UPathFollowingComponent* PathFollowing);
+
+protected:
+
+	void NavLinkClimbStep();
+
+	/* Lets the bot's path continue past the link */
+	void FinishNavLinkClimb(AClimbingMesh* ClimbableMesh);
+
+	TWeakObjectPtr<UPathFollowingComponent> NavLinkPathFollowing;
+
+	FTimerHandle NavLinkClimbTimer;
+
+#pragma endregion
+
+#pragma region Replication
+
+public:
+
+	/* 0 at the bottom of the current climb, 1 at the top. Valid on every machine */
+	UFUNCTION(BlueprintCallable)
+	float GetClimbProgress() const;
+
+protected:
+
+	UFUNCTION(Server, Reliable)
+	void ServerBeginClimb(AClimbingMesh* ClimbableMesh);
+
+	UFUNCTION(Server, Reliable)
+	void ServerEndClimb();
+
+	/* The server refused the climb - drop back to the ground */
+	UFUNCTION(Client, Reliable)
+	void ClientRejectClimb();
+
+	/* Server - registered mesh with its anchor within reach */
+	bool IsClimbValid(AClimbingMesh* ClimbableMesh) const;
+
+	void SetReplicatedClimb(AClimbingMesh* ClimbableMesh);
+
+	void UpdateReplicatedProgress();
+
+	UFUNCTION()
+	void OnRep_ReplicatedClimb();
+
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedClimb)
+	FClimbReplicationStruct ReplicatedClimb;
+
+	FTimerHandle ClimbProgressTimer;
+
+public:
+
+	/* Furthest the server accepts a climb start from the mesh's anchor */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Climbing")
+	float MaxClimbStartDistance = 200.0f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Climbing")
+	float ClimbProgressUpdateInterval = 0.2f;
+
 #pragma endregion
 
 
@@ -120,6 +201,10 @@ protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Climbing")
 	float ClimbSpeed = 5.0f;
 
+	/* Seconds between checks for a climbing mesh while the climb button is held */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Climbing")
+	float ClimbCheckInterval = 0.1f;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Climbing")
 	AClimbingMesh* CurrentClimbMesh = nullptr;
 
@@ -127,13 +212,11 @@ protected:
 	AKobWarCharacter* Owner;
 
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
-	UCharacterMovementComponent* OwnerMovementComp;
+	class UKobWarMovementComponent* OwnerMovementComp;
 
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
 	UActionControlComponent* ActionControlComp;
 
-	float DefaultGravityScale = 1.0f;
-
 public:
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
@@ -6,6 +6,8 @@
 #include "Engine/StaticMeshActor.h"
 #include "ClimbingMesh.generated.h"
 
+class UNavLinkCustomComponent;
+
 /**
  * 
  */
@@ -20,4 +22,72 @@ public:
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing Mesh")
 	USceneComponent* ClimbingMeshSceneComponent;
+
+	/* Bottom exit to top exit smart link, placed by BakeClimbData */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing Mesh")
+	UNavLinkCustomComponent* ClimbNavLink;
+
+#pragma region Baked climb data
+
+	/* Recomputes the climb range and exits from the level geometry. Also runs whenever the level is saved or cooked */
+	UFUNCTION(CallInEditor, Category = "Climbing Mesh")
+	void BakeClimbData();
+
+	/* True when a point at head height has cleared the top of the climb */
+	UFUNCTION(BlueprintCallable, Category = "Climbing Mesh")
+	bool IsAtClimbTop(const FVector& HeadLocation) const { return HeadLocation.Z >= ClimbTopZ; }
+
+	/* True when a point at the climber's feet has reached the floor at the bottom of the climb */
+	UFUNCTION(BlueprintCallable, Category = "Climbing Mesh")
+	bool IsAtClimbBottom(const FVector& FeetLocation) const { return FeetLocation.Z <= ClimbBottomZ; }
+
+#if WITH_EDITOR
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#endif
+
+#pragma endregion
+
+protected:
+
+	// Registers with the climbable subsystem
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/* A bot's path reached the nav link - hands the climb to its climbing component */
+	void OnClimbNavLinkReached(UNavLinkCustomComponent* LinkComp, UObject* PathingAgent, const FVector& DestPoint);
+
+public:
+
+#pragma region Baked climb data
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing Mesh|Baked")
+	bool HasBakedClimbData = false;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing Mesh|Baked")
+	float ClimbBottomZ = 0.0f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing Mesh|Baked")
+	float ClimbTopZ = 0.0f;
+
+	/* Floor a climber steps onto after climbing over the top */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing Mesh|Baked")
+	FVector TopExit = FVector::ZeroVector;
+
+	/* Floor at the base of the climb */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing Mesh|Baked")
+	FVector BottomExit = FVector::ZeroVector;
+
+	/* How far past the top edge the top exit is probed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Climbing Mesh|Bake Settings")
+	float TopExitDepth = 60.0f;
+
+	/* How far out from the base the bottom exit is probed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Climbing Mesh|Bake Settings")
+	float BottomExitDepth = 50.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Climbing Mesh|Bake Settings")
+	float ExitProbeHeight = 150.0f;
+
+#pragma endregion
 };
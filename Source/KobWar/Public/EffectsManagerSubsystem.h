@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EffectsManagerSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+class USceneComponent;
+
+/* Spawn budget each effect counts against */
+UENUM(BlueprintType)
+enum class EEffectCategory : uint8
+{
+	Stealth,
+	Impact,
+	Environment,
+	MAX UMETA(Hidden)
+};
+
+/* A spawned effect. Stale once the effect finishes - its component may be playing someone else's effect by then */
+USTRUCT(BlueprintType)
+struct FPooledEffectHandle
+{
+	GENERATED_BODY()
+
+	/* Only valid to touch while the effect is still playing */
+	UPROPERTY(BlueprintReadOnly)
+	UParticleSystemComponent* Effect = nullptr;
+
+	UPROPERTY()
+	int32 Generation = 0;
+};
+
+/* A component out of its pool */
+USTRUCT()
+struct FActiveEffect
+{
+	GENERATED_BODY()
+
+	EEffectCategory Category = EEffectCategory::Environment;
+
+	int32 Generation = 0;
+};
+
+/* Idle components of one template */
+USTRUCT()
+struct FEffectPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> FreeComponents;
+};
+
+/**
+ * Plays one-shot Cascade effects, or trails attached to a moving component, from per-template pools of particle
+ * system components. Pools for the configured templates are filled when the world begins play, components go back to
+ * their pool when the system finishes, and effects beyond their category's budget or further than MaxSpawnDistance
+ * from the local camera are not spawned at all. Not created on dedicated servers, where SpawnPooledEffect does nothing.
+ */
+UCLASS(config = Game)
+class KOBWAR_API UEffectsManagerSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+	/* Null Effect when the effect was culled, is over budget or this is a dedicated server. Looping templates must be given back with ReleaseEffect */
+	UFUNCTION(BlueprintCallable, Category = "Effects", meta = (WorldContext = "WorldContextObject"))
+	static FPooledEffectHandle SpawnPooledEffect(const UObject* WorldContextObject, UParticleSystem* Template, FVector Location, FRotator Rotation, EEffectCategory Category, float Scale = 1.0f);
+
+	/* Follows AttachTo until it finishes or is released, for trails. Location and Rotation are relative to the socket */
+	UFUNCTION(BlueprintCallable, Category = "Effects", meta = (WorldContext = "WorldContextObject"))
+	static FPooledEffectHandle SpawnPooledEffectAttached(const UObject* WorldContextObject, UParticleSystem* Template, USceneComponent* AttachTo, FName SocketName, FVector Location, FRotator Rotation, EEffectCategory Category, float Scale = 1.0f);
+
+	FPooledEffectHandle SpawnEffect(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, EEffectCategory Category, float Scale = 1.0f);
+
+	FPooledEffectHandle SpawnEffectAttached(UParticleSystem* Template, USceneComponent* AttachTo, FName SocketName, const FVector& Location, const FRotator& Rotation, EEffectCategory Category, float Scale = 1.0f);
+
+	/* Stops an effect early and returns it to its pool. Ignored once the effect has finished, even if its component was spawned again since */
+	UFUNCTION(BlueprintCallable, Category = "Effects")
+	void ReleaseEffect(const FPooledEffectHandle& Handle);
+
+	int32 GetActiveEffects(EEffectCategory Category) const { return ActiveCounts[(uint8)Category]; }
+
+protected:
+
+	int32 GetSpawnBudget(EEffectCategory Category) const;
+
+	/* Budget and distance checks, then an idle component of Template - null if the effect shouldn't play */
+	UParticleSystemComponent* AcquireEffect(UParticleSystem* Template, const FVector& Location, EEffectCategory Category);
+
+	FPooledEffectHandle ActivateEffect(UParticleSystemComponent* Effect, EEffectCategory Category, float Scale);
+
+	UParticleSystemComponent* CreatePooledComponent(UParticleSystem* Template);
+
+	UFUNCTION()
+	void OnEffectFinished(UParticleSystemComponent* Effect);
+
+protected:
+
+#pragma region Tuning
+
+	// Templates given PrewarmCount idle components when the world begins play
+	UPROPERTY(Config)
+	TArray<FSoftObjectPath> PrewarmTemplates;
+
+	UPROPERTY(Config)
+	int32 PrewarmCount = 4;
+
+	UPROPERTY(Config)
+	int32 MaxStealthEffects = 6;
+
+	UPROPERTY(Config)
+	int32 MaxImpactEffects = 16;
+
+	UPROPERTY(Config)
+	int32 MaxEnvironmentEffects = 12;
+
+	// Effects further than this from the local camera are never seen and are skipped
+	UPROPERTY(Config)
+	float MaxSpawnDistance = 6000.0f;
+
+#pragma endregion
+
+	UPROPERTY()
+	TMap<UParticleSystem*, FEffectPool> Pools;
+
+	UPROPERTY()
+	TMap<UParticleSystemComponent*, FActiveEffect> ActiveEffects;
+
+	int32 ActiveCounts[(uint8)EEffectCategory::MAX] = {};
+
+	int32 NextGeneration = 1;
+
+};
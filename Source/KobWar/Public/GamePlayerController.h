@@ -56,10 +56,36 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FMenuMisc2 OnMenuMisc2;
 
+#pragma region Widgets
+
+	/* False on dedicated servers and for remote controllers. Widget creation in Blueprints should be gated on this. */
+	UFUNCTION(BlueprintPure, Category = "Widgets")
+	bool CanCreateWidgets() const;
+
+#pragma endregion
+
+#pragma region Lock-on
+
+	/* Tells the server which actor this player is locked on to, so it can be replicated to them first */
+	UFUNCTION(Server, Reliable)
+	void ServerSetLockOnTarget(AActor* Target);
+
+	/* Server - the actor this connection's player is locked on to */
+	AActor* GetLockOnTargetActor() const { return LockOnTargetActor.Get(); }
+
+	/* Server - drops the lock-on target without the client's view checks, e.g. when the target is pooled */
+	void ReleaseLockOnTarget();
+
+#pragma endregion
+
 protected:
 
 	virtual void SetupInputComponent() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	TWeakObjectPtr<AActor> LockOnTargetActor;
+
 #pragma region Menu Inputs
 
 	UFUNCTION()
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "KobWarMovementComponent.generated.h"
+
+UENUM(BlueprintType)
+enum ECustomMovementMode
+{
+	CMOVE_None = 0,
+	CMOVE_Climbing = 1,
+};
+
+/**
+ * Character movement with climbing as a custom physics mode. While climbing the capsule is swept onto the climb
+ * anchor's XY and turned to face it, vertical movement comes from the climb actions' root motion, and the climbing
+ * mesh itself is ignored by the sweep instead of changing the capsule's collision profile.
+ *
+ * There are no custom saved moves. The client-authoritative base character never sends ServerMove or replays saved
+ * moves - the owning client's movement is final and only its transform goes to the server. The server enters and
+ * leaves the mode through UClimbingComponent's ServerBeginClimb / ServerEndClimb, and bots run it directly.
+ */
+UCLASS()
+class KOBWAR_API UKobWarMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Enters the climbing mode on ClimbActor, pulled towards ClimbAnchor */
+	void BeginClimb(USceneComponent* ClimbAnchor, AActor* ClimbActor);
+
+	void EndClimb();
+
+	UFUNCTION(BlueprintCallable)
+	bool IsClimbing() const { return MovementMode == MOVE_Custom && CustomMovementMode == CMOVE_Climbing; }
+
+	virtual float GetMaxSpeed() const override;
+
+protected:
+
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+
+	virtual void PhysicsRotation(float DeltaTime) override;
+
+	void PhysClimbing(float deltaTime, int32 Iterations);
+
+protected:
+
+	UPROPERTY()
+	USceneComponent* CurrentClimbAnchor = nullptr;
+
+	UPROPERTY()
+	AActor* CurrentClimbActor = nullptr;
+
+public:
+
+	/* Interp speed onto the climb anchor's XY */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float ClimbSnapSpeed = 5.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float ClimbRotationSpeed = 5.0f;
+
+	/* Within this distance of the anchor the climber is not pulled any further */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float ClimbSnapTolerance = 5.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float MaxClimbSpeed = 300.0f;
+
+};
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "KobWarQuerySubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("KobWar Queries"), STATGROUP_KobWarQuery, STATCAT_Advanced);
+
+/* Outcome of one batched trace */
+struct FKobWarQueryResult
+{
+	FHitResult Hit;
+
+	// where the trace started, so callers of TraceLatest can tell whether the answer still applies to them
+	FVector Start = FVector::ZeroVector;
+
+	uint64 Frame = 0;
+
+	bool IsHit = false;
+};
+
+DECLARE_DELEGATE_OneParam(FKobWarQueryDone, const FKobWarQueryResult& /* Result */);
+
+/* A single hit trace - a line unless Shape is set to a box, sphere or capsule */
+struct FKobWarQueryRequest
+{
+	FVector Start = FVector::ZeroVector;
+
+	FVector End = FVector::ZeroVector;
+
+	FCollisionShape Shape;
+
+	FQuat Rotation = FQuat::Identity;
+
+	TEnumAsByte<ECollisionChannel> Channel = ECC_Visibility;
+
+	TWeakObjectPtr<const AActor> IgnoreActor;
+
+	TWeakObjectPtr<const AActor> IgnoreActor2;
+};
+
+/**
+ * Gameplay trace batching. Requests collected over the frame are submitted together as async scene queries from
+ * this subsystem's tick, at most MaxQueriesPerFrame of them, and answered through their callbacks when the async
+ * results come back next frame. Callers that can use an earlier answer go through TraceLatest, which keeps the last
+ * result per owner and tag until a newer one replaces it, however long that takes - so a check made once per input
+ * still finds the answer queued on the previous input. Every query shares one scene query stat, so the physics cost
+ * shows up as a single row.
+ */
+UCLASS(config = Game)
+class KOBWAR_API UKobWarQuerySubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+#pragma region Tickable
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+#pragma endregion
+
+	/* Queues a trace for this frame's batch. Callback runs when the result comes back */
+	void RequestTrace(const FKobWarQueryRequest& Request, FKobWarQueryDone Callback);
+
+	/* Queues Request under Owner and Tag, replacing one still waiting under that key, and returns the last answer for the key */
+	bool TraceLatest(const AActor* Owner, FName Tag, const FKobWarQueryRequest& Request, FKobWarQueryResult& OutResult);
+
+	/* Queries submitted since the world started */
+	uint32 GetQueriesSubmitted() const { return QueriesSubmitted; }
+
+protected:
+
+	void Submit(const FKobWarQueryRequest& Request, uint32 QueryId);
+
+	void OnQueryCompleted(const FTraceHandle& Handle, FTraceDatum& Data);
+
+	void PruneLatestResults();
+
+protected:
+
+	typedef TPair<TWeakObjectPtr<const AActor>, FName> FKobWarQueryKey;
+
+	struct FPendingQuery
+	{
+		FKobWarQueryRequest Request;
+
+		FKobWarQueryDone Callback;
+
+		FKobWarQueryKey Key;
+	};
+
+	UPROPERTY(Config)
+	int32 MaxQueriesPerFrame = 64;
+
+	TArray<FPendingQuery> PendingQueries;
+
+	TMap<uint32, FPendingQuery> InFlightQueries;
+
+	// only dropped when the owner is gone
+	TMap<FKobWarQueryKey, FKobWarQueryResult> LatestResults;
+
+	// reused for every submit, async traces copy it
+	FCollisionQueryParams QueryParams;
+
+	FTraceDelegate TraceDelegate;
+
+	uint32 NextQueryId = 1;
+
+	uint32 QueriesSubmitted = 0;
+
+};
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Camera/CameraModifier.h"
+#include "LockOnCameraModifier.generated.h"
+
+class ULockOnTargSceneComponent;
+
+/**
+ * Turns the view towards the lock-on target. Camera modifiers run once per frame when the camera manager updates,
+ * after movement and animation, so the target position used here is final for the frame. The target is led by its
+ * velocity and the control rotation is interpolated towards it; the already computed view is rotated around the
+ * spring arm by the same amount so the new rotation shows this frame instead of the next.
+ */
+UCLASS()
+class KOBWAR_API ULockOnCameraModifier : public UCameraModifier
+{
+	GENERATED_BODY()
+
+public:
+
+	ULockOnCameraModifier();
+
+	/* Enables the modifier for a target, or disables it when Target is null */
+	void SetLockOnTarget(ULockOnTargSceneComponent* Target);
+
+	virtual bool ModifyCamera(float DeltaTime, struct FMinimalViewInfo& InOutPOV) override;
+
+protected:
+
+	TWeakObjectPtr<ULockOnTargSceneComponent> LockOnTarget;
+
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float LockOnRotSpeed = 5.0f;
+
+	/* How far ahead of the target's velocity the camera aims */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float VelocityPredictionTime = 0.15f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector PivotOffset = FVector(0.0f, 0.0f, 100.0f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector TargetOffset = FVector(0.0f, 0.0f, 50.0f);
+
+};
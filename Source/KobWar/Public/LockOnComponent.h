@@ -7,15 +7,29 @@
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "LockOnTargSceneComponent.h"
+#include "LockOnTargetSubsystem.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "LockOnComponent.generated.h"
 
 class AKobWarCharacter;
 class AGamePlayerController;
+class ULockOnCameraModifier;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FLockedOn, bool, Active, ULockOnTargSceneComponent*, TargComponent);
 
+/* A visible lock-on candidate and where it sits on screen relative to the current aim */
+struct FLockOnCandidate
+{
+	AKobWarCharacter* Character = nullptr;
+
+	ULockOnTargSceneComponent* Target = nullptr;
+
+	float AngleDistance = 0.0f;
+
+	FVector2D ScreenDirection = FVector2D::ZeroVector;	// normalized, +Y is down
+};
+
 UCLASS(Blueprintable)
 class KOBWAR_API ULockOnComponent : public UActorComponent
 {
@@ -56,9 +70,16 @@ protected:
 
 	void EndLockSwitchTimer();
 
-	bool IsPosInFov(const FVector ViewPosition, const FRotator ViewRot, const bool IsCurrentlyLockedOn, const FVector CurrentLockOnPos, const FVector TargPosition, const float Fov, float& AngleDistance, float& AngleDirection);
+	/* Screen candidates are only projected with a view - players without one fall back to the view space pick */
+	virtual bool HasScreenView() const { return OwnerPlayerController != nullptr; }
+
+	virtual bool GetViewProjection(FMatrix& ViewProjection, FIntRect& ViewRect) const;
 
-	TMap<AKobWarCharacter*, FVector2D> GetPotentialCharactersForLockOn();
+	void GetPotentialCharactersForLockOn(TArray<FLockOnCandidate>& OutCandidates);
+
+	FLockOnViewQuery MakeViewQuery() const;	// camera view for players, eye view for ai and the server
+
+	void OnBestTargetFound(ULockOnTargSceneComponent* FoundTarget);
 
 	void UpdateOwnerLockOnState(bool Toggle);
 
@@ -66,7 +87,7 @@ protected:
 
 #pragma region Lock-on facing
 
-	void InterpCamToTargetStep(float DeltaTime);
+	void InitCameraModifier();
 
 	//void InterpLockOnOffset(float DeltaTime);
 
@@ -80,6 +101,8 @@ protected:
 
 	void LockOnVerify();
 
+	void OnLockOnVerifyResult(bool Visible, ULockOnTargSceneComponent* VerifiedTarget);
+
 	// void InterpLockOnOffset(float DeltaTime);
 
 #pragma endregion
@@ -92,14 +115,26 @@ public:
 	void PauseForReason(bool Toggle, FName Reason);	// Temporarily disables lock on logic for the input reason
 #pragma endregion
 
+#pragma region Pooling
+
+	void ResetForPool();	// Drops the current target and any pause reasons so a pooled character starts unlocked
+
+#pragma endregion
+
 
 public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 	UFUNCTION(BlueprintCallable)
 	bool GetCurrentLockOnTarget(ULockOnTargSceneComponent*& TargetComponent);
 
+	/* Locks on to the best target in view without a viewport - for ai. Scored with every other request this frame */
+	UFUNCTION(BlueprintCallable)
+	void LockOnToBestTarget();
+
+	/* Server side sanity check of a target picked by a client */
+	UFUNCTION(BlueprintCallable)
+	bool IsLockOnTargetInView(ULockOnTargSceneComponent* Target) const;
+
 	//UFUNCTION(BlueprintCallable)
 	//void SetLockOnOffset(FVector2D NewOffset, float Value);
 
@@ -116,9 +151,14 @@ protected:
 
 	FRotator DefaultCamRotationRelative;
 
+	UPROPERTY()
+	ULockOnCameraModifier* LockOnCameraModifier;
+
 #pragma region Lock-on
 
-	ULockOnTargSceneComponent* LockOnTarget;
+	// a UPROPERTY so it is cleared when the target is destroyed, e.g. a stealthed target that stops being relevant
+	UPROPERTY()
+	ULockOnTargSceneComponent* LockOnTarget = nullptr;
 
 	FTimerHandle LockSwitchTimer;
 
@@ -128,6 +168,12 @@ protected:
 
 	//bool ResetLockOnOffset = false;
 
+	TArray<FLockOnCandidate> CandidateScratch = TArray<FLockOnCandidate>();	// reused between queries so switching targets doesn't allocate
+
+	TArray<int32> CandidateIndexScratch = TArray<int32>();
+
+	FLockOnProjectionBatch ProjectionBatch;
+
 #pragma endregion
 
 #pragma region Lock-on verification
@@ -161,4 +207,15 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float LockOnVerificationTime = 0.5f;
 
+	// View used when there is no camera (ai, server)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "View Query")
+	float ViewQueryFov = 90.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "View Query")
+	float ViewQueryMaxDistance = 4000.0f;
+
+	// Extra FOV degrees allowed when validating a client's target
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "View Query")
+	float ViewQueryValidationSlack = 60.0f;
+
 };
@@ -17,12 +17,9 @@ public:
 	ULockOnTargSceneComponent();
 
 protected:
-	// Called when the game starts
+	// Called when the game starts - registers with the lock-on target subsystem
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-		
 };
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "LockOnTargetSubsystem.generated.h"
+
+class ULockOnTargSceneComponent;
+
+DECLARE_DELEGATE_OneParam(FLockOnTargetFound, ULockOnTargSceneComponent* /* Target */);
+
+/* A view to pick a lock-on target from - no viewport needed, so AI and the server can use it */
+struct FLockOnViewQuery
+{
+	FVector EyePosition = FVector::ZeroVector;
+
+	FVector Forward = FVector::ForwardVector;
+
+	float FovDegrees = 90.0f;
+
+	float MaxDistance = 4000.0f;
+
+	const AActor* IgnoreActor = nullptr;
+};
+
+/* Structure-of-arrays scratch for ULockOnTargetSubsystem::ProjectBatch - fill the positions, read back the screen results */
+struct FLockOnProjectionBatch
+{
+	TArray<float> X;
+
+	TArray<float> Y;
+
+	TArray<float> Z;
+
+	TArray<float> DirX;	// normalized screen direction from the reference point, +Y is down
+
+	TArray<float> DirY;
+
+	TArray<float> AngleDistance;	// manhattan pixel distance from the reference point
+
+	TArray<uint8> OnScreen;
+
+	int32 Num = 0;
+
+	void Reset(const int32 NewNum);
+
+	void SetPosition(const int32 Index, const FVector& Position);
+};
+
+/**
+ * Registry of every lock-on target in the world. Target positions are kept in one contiguous array that is refreshed
+ * at most once per frame, so gathering lock-on candidates is a distance and cone cull over that array instead of a
+ * physics sweep. View-space queries from agents without a viewport are collected over the frame and scored
+ * together in one ParallelFor.
+ */
+UCLASS()
+class KOBWAR_API ULockOnTargetSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+#pragma region Tickable
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+#pragma endregion
+
+	void RegisterTarget(ULockOnTargSceneComponent* Target);
+
+	void UnregisterTarget(ULockOnTargSceneComponent* Target);
+
+	/* Appends the index of every visible target within MaxDistance and HalfFovDegrees of the view direction, skipping IgnoreActor's targets */
+	void GatherCandidates(const FVector& ViewPosition, const FVector& ViewDirection, const float MaxDistance, const float HalfFovDegrees, const AActor* IgnoreActor, TArray<int32>& OutIndices);
+
+	ULockOnTargSceneComponent* GetTarget(const int32 Index) const { return Targets[Index]; }
+
+	AActor* GetTargetOwner(const int32 Index) const { return TargetOwners[Index]; }
+
+	/* Target positions for this frame, index-aligned with GetTarget */
+	const TArray<FVector>& GetTargetPositions();
+
+	int32 GetNumTargets() const { return Targets.Num(); }
+
+	/* Best target for each query, index-aligned. Scores in view space - smallest angle from Forward wins - in parallel. No line of sight check */
+	void FindBestTargets(const TArray<FLockOnViewQuery>& Queries, TArray<ULockOnTargSceneComponent*>& OutTargets);
+
+	ULockOnTargSceneComponent* FindBestTarget(const FLockOnViewQuery& Query);
+
+	/* Queues a query to be scored with every other agent's at the end of the frame */
+	void RequestBestTarget(const FLockOnViewQuery& Query, FLockOnTargetFound Callback);
+
+	/* True when Target is registered and inside the query's view cone and distance */
+	bool IsTargetInView(const FLockOnViewQuery& Query, const ULockOnTargSceneComponent* Target);
+
+	/* Projects every position in the batch through ViewProjection four at a time and scores it against ReferenceScreenPos */
+	static void ProjectBatch(const FMatrix& ViewProjection, const FIntRect& ViewRect, const FVector2D& ReferenceScreenPos, FLockOnProjectionBatch& Batch);
+
+protected:
+
+	void RefreshPositions();
+
+	int32 ScoreQuery(const FLockOnViewQuery& Query) const;
+
+protected:
+
+	UPROPERTY()
+	TArray<ULockOnTargSceneComponent*> Targets;
+
+	UPROPERTY()
+	TArray<AActor*> TargetOwners;
+
+	TArray<FVector> TargetPositions;
+
+	uint64 PositionsFrame = MAX_uint64;
+
+	TArray<FLockOnViewQuery> PendingQueries;
+
+	TArray<FLockOnTargetFound> PendingCallbacks;
+
+	TArray<ULockOnTargSceneComponent*> QueryResults;
+};
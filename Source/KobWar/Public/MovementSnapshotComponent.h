@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
+#include "MovementSnapshotComponent.generated.h"
+
+class ACharacter;
+
+/* Compact movement state sent to simulated proxies - integer precision position, 16 bit yaw and velocity */
+USTRUCT()
+struct FMovementSnapshotStruct
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize Position = FVector_NetQuantize(FVector::ZeroVector);
+
+	UPROPERTY()
+	FVector_NetQuantize Velocity = FVector_NetQuantize(FVector::ZeroVector);
+
+	UPROPERTY()
+	uint16 Yaw = 0;
+
+	UPROPERTY()
+	float ServerTime = 0.0f;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FMovementSnapshotStruct> : public TStructOpsTypeTraitsBase2<FMovementSnapshotStruct>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+ * Replaces full-precision replicated movement for simulated proxies. The server writes a compact snapshot for
+ * everyone but the owner, and simulated proxies play the snapshots back through an interpolation buffer that runs
+ * InterpolationDelay behind the server clock and extrapolates for at most MaxExtrapolationTime.
+ *
+ * The client-authoritative base character only moves the owner's transform up to the server. The leg from the server
+ * to other clients is the actor's ReplicatedMovement, which this component keeps switched off on the server and which
+ * simulated proxies ignore if it arrives anyway, so the snapshots are the only thing that positions a proxy.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class KOBWAR_API UMovementSnapshotComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UMovementSnapshotComponent();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/* Drops buffered snapshots, e.g. after the owner was teleported or reused from the pawn pool */
+	void ClearSnapshotBuffer();
+
+	/* True on simulated proxies whose transform comes from the snapshots - the owner then ignores ReplicatedMovement */
+	bool IsDrivingSimulatedProxy() const;
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+
+	void WriteServerSnapshot();
+
+	void InterpolateSimulatedProxy();
+
+	float GetServerTime() const;
+
+	UFUNCTION()
+	void OnRep_Snapshot();
+
+protected:
+
+	UPROPERTY(ReplicatedUsing = OnRep_Snapshot)
+	FMovementSnapshotStruct Snapshot;
+
+	ACharacter* OwnerCharacter = nullptr;
+
+	TArray<FMovementSnapshotStruct> SnapshotBuffer = TArray<FMovementSnapshotStruct>();
+
+public:
+
+	/* When true the owner's default replicated movement is turned off and simulated proxies use the snapshots instead */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Network")
+	bool UseCompactMovementReplication = true;
+
+	/* How far behind the server clock simulated proxies render */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
+	float InterpolationDelay = 0.1f;
+
+	/* Longest time a simulated proxy keeps moving on its last velocity when snapshots stop arriving */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
+	float MaxExtrapolationTime = 0.25f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
+	uint8 MaxBufferedSnapshots = 16;
+
+};
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "MovementValidationSubsystem.generated.h"
+
+class AKobWarCharacter;
+
+/**
+ * Server-only check of client-authoritative movement. Every registered character is validated once per frame in a
+ * single pass over contiguous arrays: speed against the character's allowed move speed, teleport distance and a
+ * budgeted floor sample for characters rising while walking. Violations build up a score that escalates from a log
+ * warning to a position correction and finally a kick.
+ */
+UCLASS(config = Game)
+class KOBWAR_API UMovementValidationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Deinitialize() override;
+
+#pragma region Tickable
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+#pragma endregion
+
+	void RegisterCharacter(AKobWarCharacter* Character);
+
+	void UnregisterCharacter(AKobWarCharacter* Character);
+
+	/* Clears the history of a character that was moved by the server (respawn, pooling, corrections) */
+	void ResetCharacter(AKobWarCharacter* Character);
+
+protected:
+
+	void GatherCharacterData();
+
+	/* Adds to the violation score and warns once. True when the score has reached CorrectViolationScore */
+	bool AddViolationScore(int32 Index, const TCHAR* Reason);
+
+	/* Adds to the violation score and corrects once it reaches CorrectViolationScore */
+	void EscalateViolation(int32 Index, const TCHAR* Reason);
+
+	void ApplyCorrection(int32 Index);
+
+	void RemoveAtSwap(int32 Index);
+
+protected:
+
+#pragma region Tuning
+
+	// Multiplier over the character's allowed speed before movement counts as too fast
+	UPROPERTY(Config)
+	float SpeedTolerance = 1.25f;
+
+	// Extra allowed speed multiplier while the character is acting (root motion attacks and dodges)
+	UPROPERTY(Config)
+	float ActingSpeedMultiplier = 3.0f;
+
+	// Distance always allowed on top of the speed budget to absorb network jitter
+	UPROPERTY(Config)
+	float DistanceSlack = 50.0f;
+
+	// Any single move longer than this is treated as a teleport and corrected immediately
+	UPROPERTY(Config)
+	float TeleportDistance = 600.0f;
+
+	// Upward movement while walking above this height triggers a floor sample
+	UPROPERTY(Config)
+	float MaxStepUpHeight = 60.0f;
+
+	// Distance below the capsule a walking character must have a floor
+	UPROPERTY(Config)
+	float FloorCheckDistance = 150.0f;
+
+	UPROPERTY(Config)
+	int32 MaxFloorSamplesPerFrame = 4;
+
+	UPROPERTY(Config)
+	float ViolationDecayPerSecond = 1.0f;
+
+	UPROPERTY(Config)
+	float WarnViolationScore = 1.0f;
+
+	UPROPERTY(Config)
+	float CorrectViolationScore = 3.0f;
+
+	// Corrections in a row before the player is kicked. 0 disables kicking.
+	UPROPERTY(Config)
+	uint8 KickCorrectionCount = 0;
+
+#pragma endregion
+
+#pragma region Character data
+
+	TArray<TWeakObjectPtr<AKobWarCharacter>> Characters;
+
+	TArray<FVector> Positions;
+
+	TArray<FVector> LastValidPositions;
+
+	TArray<float> LastValidTimes;
+
+	TArray<float> AllowedSpeeds;
+
+	TArray<float> ViolationScores;
+
+	TArray<uint8> CorrectionCounts;
+
+	TArray<bool> IsWalking;
+
+	TArray<bool> HasWarned;
+
+#pragma endregion
+
+};
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavAreas/NavArea.h"
+#include "NavArea_Climb.generated.h"
+
+/**
+ * Area of the nav links on climbing meshes. A link's cost is its length times DefaultCost, so the cost is scaled by
+ * WalkSpeed over ClimbRate to make a climb cost what walking for the same time would. Everything is config on the
+ * area itself - nav areas are registered from their CDO, before any pawn class is known.
+ */
+UCLASS(config = Game)
+class KOBWAR_API UNavArea_Climb : public UNavArea
+{
+	GENERATED_BODY()
+
+public:
+
+	UNavArea_Climb(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	virtual void PostInitProperties() override;
+
+	/* Vertical cm per second while climbing. Climbing is root motion, so this is the ClimbUp montage's rise over its
+	   length - measure it again when the montage changes. MaxClimbSpeed on the movement component is not the real rate */
+	UPROPERTY(Config, EditAnywhere, Category = "Climbing")
+	float ClimbRate = 100.0f;
+
+	/* Walking speed the climb time is priced against - the BaseMovementSpeed of the characters bots drive, not the
+	   movement component's MaxWalkSpeed, which UpdateSpeed overrides at runtime */
+	UPROPERTY(Config, EditAnywhere, Category = "Climbing")
+	float WalkSpeed = 150.0f;
+
+	/* Seconds spent getting onto the wall and over the top, added once per climb */
+	UPROPERTY(Config, EditAnywhere, Category = "Climbing")
+	float ClimbOverTime = 1.5f;
+};
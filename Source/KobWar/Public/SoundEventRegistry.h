@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Engine/NetSerialization.h"
+#include "AudioManagerSubsystem.h"
+#include "SoundEventRegistry.generated.h"
+
+class USoundBase;
+
+/* How one replicated sound event plays on clients */
+USTRUCT(BlueprintType)
+struct FSoundEventDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	USoundBase* Sound = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	ESoundCategory Category = ESoundCategory::World;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float Volume = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float PitchMin = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float PitchMax = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float Priority = 1.0f;
+};
+
+/* A sound event on the wire - registry index, integer precision position and a byte picking the pitch in the event's range */
+USTRUCT()
+struct FSoundNetEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint16 EventIndex = 0;
+
+	UPROPERTY()
+	FVector_NetQuantize Location = FVector_NetQuantize(FVector::ZeroVector);
+
+	UPROPERTY()
+	uint8 PitchSeed = 0;
+};
+
+/**
+ * Every sound the server can trigger on clients. Events are sent as an index into Events, so the list must be the
+ * same asset on the server and every client.
+ */
+UCLASS(BlueprintType)
+class KOBWAR_API USoundEventRegistry : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/* INDEX_NONE when Sound isn't registered */
+	int32 FindEventIndex(const USoundBase* Sound) const;
+
+	const FSoundEventDefinition* GetEvent(const int32 Index) const { return Events.IsValidIndex(Index) ? &Events[Index] : nullptr; }
+
+protected:
+
+	void BuildIndex();
+
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sound Events")
+	TArray<FSoundEventDefinition> Events;
+
+protected:
+
+	TMap<const USoundBase*, uint16> IndexBySound;
+};
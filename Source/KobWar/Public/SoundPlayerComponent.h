@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "AudioManagerSubsystem.h"
+#include "SoundEventRegistry.h"
 #include "SoundPlayerComponent.generated.h"
 
 
@@ -24,6 +26,42 @@ public:
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+	/* Queued with the world's audio manager, which may merge, cull or drop it under its category's voice budget */
 	UFUNCTION(BlueprintCallable)
-	void PlaySoundAtPos(USoundBase* Sound, FVector WorldLoc, float VolumeMultiplier, float PitchMultiplierMin, float PitchMultiplierMax, float StartTime);
+	void PlaySoundAtPos(USoundBase* Sound, FVector WorldLoc, float VolumeMultiplier, float PitchMultiplierMin, float PitchMultiplierMax, float StartTime, ESoundCategory Category = ESoundCategory::World, float Priority = 1.0f);
+
+#pragma region Sound Events
+
+	/**
+	 * Server only - plays a registered sound on every client the owner is relevant to. Batched into one unreliable
+	 * multicast per frame. Works on any replicated actor, events from a hidden owner are dropped.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void PlaySoundEvent(USoundBase* Sound, FVector Location);
+
+	/* Drops anything still queued */
+	void ResetForPool();
+
+protected:
+
+	void FlushSoundEvents();
+
+	void PlaySoundEventLocal(const FSoundNetEvent& Event) const;
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastSoundEvents(const TArray<FSoundNetEvent>& Events);
+
+	TArray<FSoundNetEvent> PendingSoundEvents;
+
+public:
+
+	/* Must be the same asset on the server and clients */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Sound")
+	USoundEventRegistry* SoundEventRegistry = nullptr;
+
+	/* Events past this in one frame are dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sound")
+	uint8 MaxSoundEventsPerFrame = 16;
+
+#pragma endregion
 };
@@ -47,8 +47,21 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void OnOwnerDamageTaken(float Damage);
 
+	/* Light level at the owner from the level's baked light grid, 0 dark to 1 lit */
+	UFUNCTION(BlueprintCallable)
+	float GetLightLevel() const;
+
+	/* Drops stealth without the locally-controlled check so a pooled character is visible again on every machine */
+	void ResetForPool();
+
 protected:
 
+	/* The server needs the stealth state for the owner's move speed and for stealth perception */
+	UFUNCTION(Server, Reliable)
+	void ServerToggleStealth(bool Activate);
+
+	void ApplyStealth(bool Activate);
+
 	AKobWarCharacter* Owner;
 
 	bool IsStealthed = false;
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "StealthLightGrid.generated.h"
+
+class UBoxComponent;
+
+/**
+ * Rough light level over the BakeBounds box, a byte per cell saved with the map. It is not the engine's precomputed
+ * lighting - each cell is an analytic estimate from the static and stationary lights' intensity, falloff and cone,
+ * with shadowing from collision traces, so it ignores bounce light, materials and anything without collision.
+ * Place one per level. Lookups are a trilinear blend of the eight surrounding cells, so stealth gets lighting on a
+ * dedicated server without a renderer.
+ */
+UCLASS()
+class KOBWAR_API AStealthLightGrid : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AStealthLightGrid();
+
+	/* Samples every light in the level into the grid - O(cells x lights) traces. The only bake - a cook just warns when the grid is stale */
+	UFUNCTION(CallInEditor, Category = "Light Grid")
+	void BakeLightGrid();
+
+	/* 0 dark to 1 lit. False when Position is outside the baked grid */
+	bool SampleLightLevel(const FVector& Position, float& OutLevel) const;
+
+#if WITH_EDITOR
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#endif
+
+protected:
+
+	// Registers with the stealth perception subsystem
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	uint8 GetCell(const int32 X, const int32 Y, const int32 Z) const { return LightLevels[(Z * GridSize.Y + Y) * GridSize.X + X]; }
+
+public:
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Light Grid")
+	UBoxComponent* BakeBounds;
+
+#pragma region Bake settings
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Light Grid|Bake Settings")
+	float CellSize = 500.0f;
+
+	/* Refuses to bake grids larger than this many cells */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Light Grid|Bake Settings")
+	int32 MaxCells = 262144;
+
+	/* Level everywhere gets before any light is added */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Light Grid|Bake Settings")
+	float AmbientLevel = 0.05f;
+
+	/* Point and spot light intensity that fully lights a cell at the light's position */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Light Grid|Bake Settings")
+	float FullBrightIntensity = 5000.0f;
+
+	/* Level a directional light adds to cells with an open line towards it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Light Grid|Bake Settings")
+	float DirectionalLevel = 0.8f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Light Grid|Bake Settings")
+	float DirectionalTraceDistance = 20000.0f;
+
+#pragma endregion
+
+#pragma region Baked data
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Light Grid|Baked")
+	FVector GridOrigin = FVector::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Light Grid|Baked")
+	FIntVector GridSize = FIntVector::ZeroValue;
+
+	UPROPERTY()
+	TArray<uint8> LightLevels;
+
+#pragma endregion
+};
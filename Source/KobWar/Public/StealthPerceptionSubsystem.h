@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "StealthPerceptionSubsystem.generated.h"
+
+class AKobWarCharacter;
+class AStealthLightGrid;
+class UVisibilitySubsystem;
+
+/* How far one observer has noticed one stealthed target */
+struct FStealthPairState
+{
+	float Detection = 0.0f;
+
+	float LastEvalTime = -1.0f;
+
+	// last line of sight answer from the visibility service, refreshed on every evaluation
+	bool Visible = false;
+};
+
+/**
+ * Server-side stealth detection. Each registered character keeps a 0-1 detection value for every stealthed enemy
+ * near it, built up from distance, the target's speed, whether the observer is facing it and the light level at the
+ * target. Exposure is zero while the visibility service reports the line of sight as blocked. Stealthed characters
+ * are bucketed in a 2D grid of PerceptionRange sized cells, so an observer only scores targets in its own and the
+ * neighbouring cells, and only ObserversPerFrame observers are evaluated each frame. Stealthing in plain sight doesn't
+ * shake anyone - an observer with line of sight to a target that stealthed within StealthSeedTime starts fully detecting it.
+ * The detection drives net relevancy, lock-on eligibility and bot awareness.
+ */
+UCLASS(config = Game)
+class KOBWAR_API UStealthPerceptionSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+#pragma region Tickable
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+#pragma endregion
+
+	void RegisterCharacter(AKobWarCharacter* Character);
+
+	void UnregisterCharacter(AKobWarCharacter* Character);
+
+	/* 0 when Observer hasn't noticed Target, 1 when fully detected. Targets that aren't stealthed, teammates and non-character observers are always 1 */
+	UFUNCTION(BlueprintCallable, Category = "Stealth")
+	float GetDetection(const AActor* Observer, const AActor* Target) const;
+
+	/* True when the detection is at least DetectedThreshold - enough to lock on or for a bot to react */
+	UFUNCTION(BlueprintCallable, Category = "Stealth")
+	bool IsDetected(const AActor* Observer, const AActor* Target) const;
+
+	void RegisterLightGrid(AStealthLightGrid* Grid);
+
+	void UnregisterLightGrid(AStealthLightGrid* Grid);
+
+	/* 0 dark to 1 lit from the level's baked light grid, DefaultLightLevel outside it */
+	UFUNCTION(BlueprintCallable, Category = "Stealth")
+	float GetLightLevel(const FVector& Position) const;
+
+protected:
+
+	void GatherCharacterData(const float Now);
+
+	void BuildGrid();
+
+	void EvaluateObserver(const int32 ObserverIndex, const float Now);
+
+	void PrunePairs(const float Now);
+
+	void OnVisibilityResult(bool Visible, uint64 PairKey);
+
+	FIntPoint GetCell(const FVector& Position) const;
+
+	void RemoveAtSwap(int32 Index);
+
+	static uint64 MakePairKey(const uint32 ObserverId, const uint32 TargetId) { return ((uint64)ObserverId << 32) | TargetId; }
+
+protected:
+
+#pragma region Tuning
+
+	// Furthest a stealthed target can be noticed from, also the grid cell size
+	UPROPERTY(Config)
+	float PerceptionRange = 2500.0f;
+
+	UPROPERTY(Config)
+	int32 ObserversPerFrame = 8;
+
+	// Detection gained per second at full exposure
+	UPROPERTY(Config)
+	float GainPerSecond = 1.5f;
+
+	// Detection lost per second, always applied - exposure has to beat it for detection to rise
+	UPROPERTY(Config)
+	float DecayPerSecond = 0.5f;
+
+	// Target speed that counts as fully moving
+	UPROPERTY(Config)
+	float MovingSpeed = 300.0f;
+
+	// Exposure multiplier for a target standing still
+	UPROPERTY(Config)
+	float StillFactor = 0.35f;
+
+	// Exposure multiplier for a target directly behind the observer
+	UPROPERTY(Config)
+	float RearFactor = 0.15f;
+
+	// Exposure multiplier for a target in full darkness
+	UPROPERTY(Config)
+	float DarkFactor = 0.2f;
+
+	// Light level assumed where the level has no light data, 0 dark to 1 lit
+	UPROPERTY(Config)
+	float DefaultLightLevel = 1.0f;
+
+	UPROPERTY(Config)
+	float DetectedThreshold = 0.5f;
+
+	// Seconds a pair keeps its detection after it was last evaluated
+	UPROPERTY(Config)
+	float PairTimeout = 2.0f;
+
+	// A pair first scored this soon after its target stealthed starts detected when the observer can see the target
+	UPROPERTY(Config)
+	float StealthSeedTime = 1.0f;
+
+#pragma endregion
+
+#pragma region Character data
+
+	TArray<TWeakObjectPtr<AKobWarCharacter>> Characters;
+
+	TArray<uint32> Ids;
+
+	TArray<FVector> Positions;
+
+	TArray<FVector> EyePositions;
+
+	TArray<FVector> ViewDirections;
+
+	TArray<float> Speeds;
+
+	TArray<uint8> Teams;
+
+	TArray<bool> IsStealthed;
+
+	TArray<float> StealthStartTimes;
+
+	// pooled characters don't observe
+	TArray<bool> IsObserving;
+
+	TMap<TWeakObjectPtr<const AActor>, uint32> IdsByActor;
+
+	uint32 NextId = 1;
+
+#pragma endregion
+
+	// stealthed character indices per cell
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Grid;
+
+	TMap<uint64, FStealthPairState> Pairs;
+
+	int32 ObserverCursor = 0;
+
+	TWeakObjectPtr<AStealthLightGrid> LightGrid;
+
+	UPROPERTY()
+	UVisibilitySubsystem* VisibilitySubsystem = nullptr;
+
+	int32 NumStealthed = 0;
+
+};
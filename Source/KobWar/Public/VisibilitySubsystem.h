@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "VisibilitySubsystem.generated.h"
+
+class UKobWarQuerySubsystem;
+struct FKobWarQueryResult;
+
+DECLARE_DELEGATE_OneParam(FVisibilityResult, bool /* Visible */);
+
+/* One observer -> target line of sight check and everyone waiting on its answer */
+struct FVisibilityRequest
+{
+	TWeakObjectPtr<AActor> Observer;
+
+	TWeakObjectPtr<AActor> Target;
+
+	FVector Start = FVector::ZeroVector;
+
+	FVector End = FVector::ZeroVector;
+
+	TArray<FVisibilityResult, TInlineAllocator<2>> Callbacks;
+
+	uint32 RequestId = 0;
+};
+
+/* Last known line of sight between a pair and where both ends were when it was traced */
+struct FVisibilityCacheEntry
+{
+	FVector Start = FVector::ZeroVector;
+
+	FVector End = FVector::ZeroVector;
+
+	uint64 Frame = 0;
+
+	bool Visible = false;
+};
+
+/**
+ * Shared line of sight service for lock-on, stealth and AI. Requests for the same observer / target pair are merged,
+ * queued and handed to the query subsystem's batch at most MaxTracesPerFrame per frame, so the cost stays flat however
+ * many timers happen to fire on the same frame. Results arrive through the request callbacks a frame later.
+ * Every answer is cached per pair for CacheValidFrames frames, or until either end moves more than CacheMoveThreshold.
+ */
+UCLASS(config = Game)
+class KOBWAR_API UVisibilitySubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+#pragma region Tickable
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+#pragma endregion
+
+	/* Queues a trace from Start to End ignoring both actors. Callback receives true when nothing blocks the line */
+	void RequestVisibility(AActor* Observer, AActor* Target, const FVector& Start, const FVector& End, FVisibilityResult Callback);
+
+	/* Synchronous version for callers that need the answer this frame - only traces when the cache is stale */
+	bool TestVisibility(AActor* Observer, AActor* Target, const FVector& Start, const FVector& End);
+
+	bool GetCachedVisibility(AActor* Observer, AActor* Target, const FVector& Start, const FVector& End, bool& OutVisible) const;
+
+	/* Sync and async traces issued since the world started */
+	uint32 GetTracesIssued() const { return TracesIssued; }
+
+	void ClearCache() { VisibilityCache.Reset(); }
+
+protected:
+
+	void StoreVisibility(AActor* Observer, AActor* Target, const FVector& Start, const FVector& End, const bool Visible);
+
+	void PruneCache();
+
+	void IssueTrace(FVisibilityRequest&& Request);
+
+	void OnTraceCompleted(const FKobWarQueryResult& Result, uint32 RequestId);
+
+protected:
+
+	UPROPERTY(Config)
+	int32 MaxTracesPerFrame = 8;
+
+	// Frames a cached answer stays valid while neither end moves
+	UPROPERTY(Config)
+	int32 CacheValidFrames = 6;
+
+	// Distance either end may move before a cached answer is ignored
+	UPROPERTY(Config)
+	float CacheMoveThreshold = 25.0f;
+
+	TMap<TPair<TWeakObjectPtr<AActor>, TWeakObjectPtr<AActor>>, FVisibilityCacheEntry> VisibilityCache;
+
+	TArray<FVisibilityRequest> PendingRequests;
+
+	TMap<uint32, FVisibilityRequest> InFlightRequests;
+
+	UPROPERTY()
+	UKobWarQuerySubsystem* QuerySubsystem = nullptr;
+
+	uint32 NextRequestId = 1;
+
+	uint32 TracesIssued = 0;
+
+};